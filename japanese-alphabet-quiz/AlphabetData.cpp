@@ -1,48 +1,54 @@
 #include "AlphabetData.h"
+#include "Romanizer.h"
 
 namespace AlphabetData {
-const std::vector<std::vector<KanaEntry>> Hiragana = {
-    {{u8"あ", "a"}, {u8"い", "i"}, {u8"う", "u"}, {u8"え", "e"}, {u8"お", "o"}},
-    {{u8"か", "ka"}, {u8"き", "ki"}, {u8"く", "ku"}, {u8"け", "ke"}, {u8"こ", "ko"}},
-    {{u8"さ", "sa"}, {u8"し", "shi"}, {u8"す", "su"}, {u8"せ", "se"}, {u8"そ", "so"}},
-    {{u8"た", "ta"}, {u8"ち", "chi"}, {u8"つ", "tsu"}, {u8"て", "te"}, {u8"と", "to"}},
-    {{u8"な", "na"}, {u8"に", "ni"}, {u8"ぬ", "nu"}, {u8"ね", "ne"}, {u8"の", "no"}},
-    {{u8"は", "ha"}, {u8"ひ", "hi"}, {u8"ふ", "fu"}, {u8"へ", "he"}, {u8"ほ", "ho"}},
-    {{u8"ま", "ma"}, {u8"み", "mi"}, {u8"む", "mu"}, {u8"め", "me"}, {u8"も", "mo"}},
-    {{u8"や", "ya"}, {"", ""}, {u8"ゆ", "yu"}, {"", ""}, {u8"よ", "yo"}},
-    {{u8"ら", "ra"}, {u8"り", "ri"}, {u8"る", "ru"}, {u8"れ", "re"}, {u8"ろ", "ro"}},
-    {{u8"わ", "wa"}, {"", ""}, {"", ""}, {"", ""}, {u8"を", "wo"}},
-    {{u8"ん", "n"}, {"", ""}, {"", ""}, {"", ""}, {"", ""}},
-    {{u8"が", "ga"}, {u8"ぎ", "gi"}, {u8"ぐ", "gu"}, {u8"げ", "ge"}, {u8"ご", "go"}},
-    {{u8"ざ", "za"}, {u8"じ", "ji"}, {u8"ず", "zu"}, {u8"ぜ", "ze"}, {u8"ぞ", "zo"}},
-    {{u8"だ", "da"}, {u8"ぢ", "ji"}, {u8"づ", "zu"}, {u8"で", "de"}, {u8"ど", "do"}},
-    {{u8"ば", "ba"}, {u8"び", "bi"}, {u8"ぶ", "bu"}, {u8"べ", "be"}, {u8"ぼ", "bo"}},
-    {{u8"ぱ", "pa"}, {u8"ぴ", "pi"}, {u8"ぷ", "pu"}, {u8"ぺ", "pe"}, {u8"ぽ", "po"}}
-};
-
-const std::vector<std::vector<KanaEntry>> Katakana = {
-    {{u8"ア", "a"}, {u8"イ", "i"}, {u8"ウ", "u"}, {u8"エ", "e"}, {u8"オ", "o"}},
-    {{u8"カ", "ka"}, {u8"キ", "ki"}, {u8"ク", "ku"}, {u8"ケ", "ke"}, {u8"コ", "ko"}},
-    {{u8"サ", "sa"}, {u8"シ", "shi"}, {u8"ス", "su"}, {u8"セ", "se"}, {u8"ソ", "so"}},
-    {{u8"タ", "ta"}, {u8"チ", "chi"}, {u8"ツ", "tsu"}, {u8"テ", "te"}, {u8"ト", "to"}},
-    {{u8"ナ", "na"}, {u8"ニ", "ni"}, {u8"ヌ", "nu"}, {u8"ネ", "ne"}, {u8"ノ", "no"}},
-    {{u8"ハ", "ha"}, {u8"ヒ", "hi"}, {u8"フ", "fu"}, {u8"ヘ", "he"}, {u8"ホ", "ho"}},
-    {{u8"マ", "ma"}, {u8"ミ", "mi"}, {u8"ム", "mu"}, {u8"メ", "me"}, {u8"モ", "mo"}},
-    {{u8"ヤ", "ya"}, {"", ""}, {u8"ユ", "yu"}, {"", ""}, {u8"ヨ", "yo"}},
-    {{u8"ラ", "ra"}, {u8"リ", "ri"}, {u8"ル", "ru"}, {u8"レ", "re"}, {u8"ロ", "ro"}},
-    {{u8"ワ", "wa"}, {"", ""}, {"", ""}, {"", ""}, {u8"ヲ", "wo"}},
-    {{u8"ン", "n"}, {"", ""}, {"", ""}, {"", ""}, {"", ""}},
-    {{u8"ガ", "ga"}, {u8"ギ", "gi"}, {u8"グ", "gu"}, {u8"ゲ", "ge"}, {u8"ゴ", "go"}},
-    {{u8"ザ", "za"}, {u8"ジ", "ji"}, {u8"ズ", "zu"}, {u8"ゼ", "ze"}, {u8"ゾ", "zo"}},
-    {{u8"ダ", "da"}, {u8"ヂ", "ji"}, {u8"ヅ", "zu"}, {u8"デ", "de"}, {u8"ド", "do"}},
-    {{u8"バ", "ba"}, {u8"ビ", "bi"}, {u8"ブ", "bu"}, {u8"ベ", "be"}, {u8"ボ", "bo"}},
-    {{u8"パ", "pa"}, {u8"ピ", "pi"}, {u8"プ", "pu"}, {u8"ペ", "pe"}, {u8"ポ", "po"}}
-};
-
-const std::vector<std::vector<KanaEntry>> Kanji = {
-    {{u8"日", "nichi"}, {u8"月", "getsu"}, {u8"火", "ka"}, {u8"水", "sui"}, {u8"木", "moku"}},
-    {{u8"金", "kin"}, {u8"土", "do"}, {u8"山", "yama"}, {u8"川", "kawa"}, {u8"人", "hito"}},
-    {{u8"口", "kuchi"}, {u8"目", "me"}, {u8"耳", "mimi"}, {u8"手", "te"}, {u8"足", "ashi"}},
-    {{u8"力", "chikara"}}
-};
+
+static std::u16string_view view(QStringView s) {
+    return std::u16string_view(reinterpret_cast<const char16_t *>(s.utf16()), static_cast<std::size_t>(s.size()));
+}
+
+CharId findKana(QStringView kana) {
+    return findKana(view(kana));
+}
+
+CharSpan findRomaji(QStringView romaji) {
+    return findRomaji(view(romaji));
+}
+
+bool romajiEquals(CharId id, QStringView romaji) {
+    return detail::keyEquals(Cells[id].romaji, view(romaji));
+}
+
+QString kanaText(CharId id) {
+    const auto &kana = Cells[id].kana;
+    return QString::fromUtf8(kana.data(), static_cast<qsizetype>(kana.size()));
+}
+
+QString romajiText(CharId id) {
+    const auto &romaji = Cells[id].romaji;
+    return QString::fromLatin1(romaji.data(), static_cast<qsizetype>(romaji.size()));
+}
+
+// 0 for hiragana, 1 for katakana, -1 for anything else or a mix; the
+// long mark belongs to either
+static int kanaScript(QStringView kana) {
+    int script = -1;
+    for (QChar c : kana) {
+        const char16_t u = c.unicode();
+        if (u == u'ー') continue;
+        int s = u >= 0x3041 && u <= 0x309F ? 0 : u >= 0x30A0 && u <= 0x30FF ? 1 : -1;
+        if (s < 0 || (script >= 0 && s != script)) return -1;
+        script = s;
+    }
+    return script;
+}
+
+bool sameReading(QStringView expected, QStringView typed) {
+    if (expected == typed) return true;
+    // Whole readings, so kana of another length that spell the same romaji
+    // count too (ヲ for ウォ)
+    const int script = kanaScript(expected);
+    return script >= 0 && script == kanaScript(typed) && Romanizer::toRomaji(expected) == Romanizer::toRomaji(typed);
+}
+
 }
@@ -1,17 +1,413 @@
 #ifndef ALPHABETDATA_H
 #define ALPHABETDATA_H
-#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 #include <QString>
+#include <QStringView>
 
 struct KanaEntry {
     QString kana;
     QString romaji;
 };
 
+// The kana tables are constexpr so they live in .rodata and need no
+// allocation at startup. Every non-empty table cell is one entry of Cells,
+// ordered by script, row and column; its index is the character's CharId.
 namespace AlphabetData {
-    extern const std::vector<std::vector<KanaEntry>> Hiragana;
-    extern const std::vector<std::vector<KanaEntry>> Katakana;
-    extern const std::vector<std::vector<KanaEntry>> Kanji;
+
+using CharId = std::uint16_t;
+inline constexpr CharId InvalidChar = 0xFFFF;
+
+enum class Script : std::uint8_t { Hiragana, Katakana, Kanji };
+inline constexpr int ScriptCount = 3;
+
+struct KanaCell {
+    std::string_view kana;   // UTF-8
+    std::string_view romaji;
+    Script script;
+    std::uint8_t row;
+    std::uint8_t col;
+};
+
+#define KANA_ROW5(S, R, K0, R0, K1, R1, K2, R2, K3, R3, K4, R4) \
+    {K0, R0, S, R, 0}, {K1, R1, S, R, 1}, {K2, R2, S, R, 2}, {K3, R3, S, R, 3}, {K4, R4, S, R, 4}
+// Yōon sit under the ya, yu and yo columns of the ya row
+#define KANA_YOON(S, R, K0, R0, K2, R2, K4, R4) \
+    {K0, R0, S, R, 0}, {K2, R2, S, R, 2}, {K4, R4, S, R, 4}
+
+inline constexpr KanaCell Cells[] = {
+    KANA_ROW5(Script::Hiragana, 0, u8"あ", "a", u8"い", "i", u8"う", "u", u8"え", "e", u8"お", "o"),
+    KANA_ROW5(Script::Hiragana, 1, u8"か", "ka", u8"き", "ki", u8"く", "ku", u8"け", "ke", u8"こ", "ko"),
+    KANA_ROW5(Script::Hiragana, 2, u8"さ", "sa", u8"し", "shi", u8"す", "su", u8"せ", "se", u8"そ", "so"),
+    KANA_ROW5(Script::Hiragana, 3, u8"た", "ta", u8"ち", "chi", u8"つ", "tsu", u8"て", "te", u8"と", "to"),
+    KANA_ROW5(Script::Hiragana, 4, u8"な", "na", u8"に", "ni", u8"ぬ", "nu", u8"ね", "ne", u8"の", "no"),
+    KANA_ROW5(Script::Hiragana, 5, u8"は", "ha", u8"ひ", "hi", u8"ふ", "fu", u8"へ", "he", u8"ほ", "ho"),
+    KANA_ROW5(Script::Hiragana, 6, u8"ま", "ma", u8"み", "mi", u8"む", "mu", u8"め", "me", u8"も", "mo"),
+    {u8"や", "ya", Script::Hiragana, 7, 0}, {u8"ゆ", "yu", Script::Hiragana, 7, 2}, {u8"よ", "yo", Script::Hiragana, 7, 4},
+    KANA_ROW5(Script::Hiragana, 8, u8"ら", "ra", u8"り", "ri", u8"る", "ru", u8"れ", "re", u8"ろ", "ro"),
+    {u8"わ", "wa", Script::Hiragana, 9, 0}, {u8"を", "wo", Script::Hiragana, 9, 4},
+    {u8"ん", "n", Script::Hiragana, 10, 0},
+    KANA_ROW5(Script::Hiragana, 11, u8"が", "ga", u8"ぎ", "gi", u8"ぐ", "gu", u8"げ", "ge", u8"ご", "go"),
+    KANA_ROW5(Script::Hiragana, 12, u8"ざ", "za", u8"じ", "ji", u8"ず", "zu", u8"ぜ", "ze", u8"ぞ", "zo"),
+    KANA_ROW5(Script::Hiragana, 13, u8"だ", "da", u8"ぢ", "ji", u8"づ", "zu", u8"で", "de", u8"ど", "do"),
+    KANA_ROW5(Script::Hiragana, 14, u8"ば", "ba", u8"び", "bi", u8"ぶ", "bu", u8"べ", "be", u8"ぼ", "bo"),
+    KANA_ROW5(Script::Hiragana, 15, u8"ぱ", "pa", u8"ぴ", "pi", u8"ぷ", "pu", u8"ぺ", "pe", u8"ぽ", "po"),
+    KANA_YOON(Script::Hiragana, 16, u8"きゃ", "kya", u8"きゅ", "kyu", u8"きょ", "kyo"),
+    KANA_YOON(Script::Hiragana, 17, u8"しゃ", "sha", u8"しゅ", "shu", u8"しょ", "sho"),
+    KANA_YOON(Script::Hiragana, 18, u8"ちゃ", "cha", u8"ちゅ", "chu", u8"ちょ", "cho"),
+    KANA_YOON(Script::Hiragana, 19, u8"にゃ", "nya", u8"にゅ", "nyu", u8"にょ", "nyo"),
+    KANA_YOON(Script::Hiragana, 20, u8"ひゃ", "hya", u8"ひゅ", "hyu", u8"ひょ", "hyo"),
+    KANA_YOON(Script::Hiragana, 21, u8"みゃ", "mya", u8"みゅ", "myu", u8"みょ", "myo"),
+    KANA_YOON(Script::Hiragana, 22, u8"りゃ", "rya", u8"りゅ", "ryu", u8"りょ", "ryo"),
+    KANA_YOON(Script::Hiragana, 23, u8"ぎゃ", "gya", u8"ぎゅ", "gyu", u8"ぎょ", "gyo"),
+    KANA_YOON(Script::Hiragana, 24, u8"じゃ", "ja", u8"じゅ", "ju", u8"じょ", "jo"),
+    KANA_YOON(Script::Hiragana, 25, u8"びゃ", "bya", u8"びゅ", "byu", u8"びょ", "byo"),
+    KANA_YOON(Script::Hiragana, 26, u8"ぴゃ", "pya", u8"ぴゅ", "pyu", u8"ぴょ", "pyo"),
+
+    KANA_ROW5(Script::Katakana, 0, u8"ア", "a", u8"イ", "i", u8"ウ", "u", u8"エ", "e", u8"オ", "o"),
+    KANA_ROW5(Script::Katakana, 1, u8"カ", "ka", u8"キ", "ki", u8"ク", "ku", u8"ケ", "ke", u8"コ", "ko"),
+    KANA_ROW5(Script::Katakana, 2, u8"サ", "sa", u8"シ", "shi", u8"ス", "su", u8"セ", "se", u8"ソ", "so"),
+    KANA_ROW5(Script::Katakana, 3, u8"タ", "ta", u8"チ", "chi", u8"ツ", "tsu", u8"テ", "te", u8"ト", "to"),
+    KANA_ROW5(Script::Katakana, 4, u8"ナ", "na", u8"ニ", "ni", u8"ヌ", "nu", u8"ネ", "ne", u8"ノ", "no"),
+    KANA_ROW5(Script::Katakana, 5, u8"ハ", "ha", u8"ヒ", "hi", u8"フ", "fu", u8"ヘ", "he", u8"ホ", "ho"),
+    KANA_ROW5(Script::Katakana, 6, u8"マ", "ma", u8"ミ", "mi", u8"ム", "mu", u8"メ", "me", u8"モ", "mo"),
+    {u8"ヤ", "ya", Script::Katakana, 7, 0}, {u8"ユ", "yu", Script::Katakana, 7, 2}, {u8"ヨ", "yo", Script::Katakana, 7, 4},
+    KANA_ROW5(Script::Katakana, 8, u8"ラ", "ra", u8"リ", "ri", u8"ル", "ru", u8"レ", "re", u8"ロ", "ro"),
+    {u8"ワ", "wa", Script::Katakana, 9, 0}, {u8"ヲ", "wo", Script::Katakana, 9, 4},
+    {u8"ン", "n", Script::Katakana, 10, 0},
+    KANA_ROW5(Script::Katakana, 11, u8"ガ", "ga", u8"ギ", "gi", u8"グ", "gu", u8"ゲ", "ge", u8"ゴ", "go"),
+    KANA_ROW5(Script::Katakana, 12, u8"ザ", "za", u8"ジ", "ji", u8"ズ", "zu", u8"ゼ", "ze", u8"ゾ", "zo"),
+    KANA_ROW5(Script::Katakana, 13, u8"ダ", "da", u8"ヂ", "ji", u8"ヅ", "zu", u8"デ", "de", u8"ド", "do"),
+    KANA_ROW5(Script::Katakana, 14, u8"バ", "ba", u8"ビ", "bi", u8"ブ", "bu", u8"ベ", "be", u8"ボ", "bo"),
+    KANA_ROW5(Script::Katakana, 15, u8"パ", "pa", u8"ピ", "pi", u8"プ", "pu", u8"ペ", "pe", u8"ポ", "po"),
+    KANA_YOON(Script::Katakana, 16, u8"キャ", "kya", u8"キュ", "kyu", u8"キョ", "kyo"),
+    KANA_YOON(Script::Katakana, 17, u8"シャ", "sha", u8"シュ", "shu", u8"ショ", "sho"),
+    KANA_YOON(Script::Katakana, 18, u8"チャ", "cha", u8"チュ", "chu", u8"チョ", "cho"),
+    KANA_YOON(Script::Katakana, 19, u8"ニャ", "nya", u8"ニュ", "nyu", u8"ニョ", "nyo"),
+    KANA_YOON(Script::Katakana, 20, u8"ヒャ", "hya", u8"ヒュ", "hyu", u8"ヒョ", "hyo"),
+    KANA_YOON(Script::Katakana, 21, u8"ミャ", "mya", u8"ミュ", "myu", u8"ミョ", "myo"),
+    KANA_YOON(Script::Katakana, 22, u8"リャ", "rya", u8"リュ", "ryu", u8"リョ", "ryo"),
+    KANA_YOON(Script::Katakana, 23, u8"ギャ", "gya", u8"ギュ", "gyu", u8"ギョ", "gyo"),
+    KANA_YOON(Script::Katakana, 24, u8"ジャ", "ja", u8"ジュ", "ju", u8"ジョ", "jo"),
+    KANA_YOON(Script::Katakana, 25, u8"ビャ", "bya", u8"ビュ", "byu", u8"ビョ", "byo"),
+    KANA_YOON(Script::Katakana, 26, u8"ピャ", "pya", u8"ピュ", "pyu", u8"ピョ", "pyo"),
+    // Extended katakana for loanwords
+    {u8"ファ", "fa", Script::Katakana, 27, 0}, {u8"フィ", "fi", Script::Katakana, 27, 1},
+    {u8"フェ", "fe", Script::Katakana, 27, 3}, {u8"フォ", "fo", Script::Katakana, 27, 4},
+    KANA_ROW5(Script::Katakana, 28, u8"ヴァ", "va", u8"ヴィ", "vi", u8"ヴ", "vu", u8"ヴェ", "ve", u8"ヴォ", "vo"),
+    {u8"ウィ", "wi", Script::Katakana, 29, 1}, {u8"ウェ", "we", Script::Katakana, 29, 3}, {u8"ウォ", "wo", Script::Katakana, 29, 4},
+    {u8"ティ", "ti", Script::Katakana, 30, 1}, {u8"トゥ", "tu", Script::Katakana, 30, 2}, {u8"チェ", "che", Script::Katakana, 30, 3},
+    {u8"ディ", "di", Script::Katakana, 31, 1}, {u8"ドゥ", "du", Script::Katakana, 31, 2}, {u8"ジェ", "je", Script::Katakana, 31, 3},
+    {u8"シェ", "she", Script::Katakana, 32, 3},
+
+    KANA_ROW5(Script::Kanji, 0, u8"日", "nichi", u8"月", "getsu", u8"火", "ka", u8"水", "sui", u8"木", "moku"),
+    KANA_ROW5(Script::Kanji, 1, u8"金", "kin", u8"土", "do", u8"山", "yama", u8"川", "kawa", u8"人", "hito"),
+    KANA_ROW5(Script::Kanji, 2, u8"口", "kuchi", u8"目", "me", u8"耳", "mimi", u8"手", "te", u8"足", "ashi"),
+    {u8"力", "chikara", Script::Kanji, 3, 0}
+};
+
+#undef KANA_ROW5
+#undef KANA_YOON
+
+inline constexpr std::size_t CellCount = sizeof(Cells) / sizeof(Cells[0]);
+static_assert(CellCount < InvalidChar, "CharId must fit in 16 bits");
+
+// Row metadata: rows are contiguous ranges of Cells.
+struct RowSpan {
+    std::uint16_t firstCell;
+    std::uint16_t cellCount;
+};
+
+struct ScriptInfo {
+    std::uint16_t firstCell;
+    std::uint16_t cellCount;
+    std::uint16_t firstRow;   // index into Rows
+    std::uint16_t rowCount;
+    std::uint16_t columnCount;
+};
+
+// A contiguous run of CharIds (several kana can share one romaji).
+struct CharSpan {
+    const CharId *first = nullptr;
+    std::size_t count = 0;
+    constexpr const CharId *begin() const { return first; }
+    constexpr const CharId *end() const { return first + count; }
+    constexpr bool empty() const { return count == 0; }
+};
+
+namespace detail {
+
+constexpr std::size_t nextPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Hashes are defined over Unicode code points so UTF-8 keys (compile time)
+// and UTF-16 QStrings (run time) hash identically.
+constexpr std::uint32_t hashStart(std::uint32_t seed) { return 0x811c9dc5u ^ (seed * 0x9e3779b9u); }
+constexpr std::uint32_t hashStep(std::uint32_t h, std::uint32_t cp) { return (h ^ cp) * 0x01000193u; }
+constexpr std::uint32_t hashFinish(std::uint32_t h) {
+    h ^= h >> 16; h *= 0x85ebca6bu;
+    h ^= h >> 13; h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+constexpr char32_t decodeUtf8(std::string_view s, std::size_t &i) {
+    auto b = static_cast<unsigned char>(s[i++]);
+    if (b < 0x80) return b;
+    int extra = b >= 0xF0 ? 3 : b >= 0xE0 ? 2 : 1;
+    char32_t cp = b & (0x3F >> extra);
+    while (extra-- > 0 && i < s.size())
+        cp = (cp << 6) | (static_cast<unsigned char>(s[i++]) & 0x3F);
+    return cp;
+}
+
+constexpr char32_t decodeUtf16(std::u16string_view s, std::size_t &i) {
+    char32_t c = s[i++];
+    if (c >= 0xD800 && c < 0xDC00 && i < s.size() && s[i] >= 0xDC00 && s[i] < 0xE000)
+        c = 0x10000 + ((c - 0xD800) << 10) + (s[i++] - 0xDC00);
+    return c;
+}
+
+constexpr std::uint32_t hashKey(std::string_view s, std::uint32_t seed) {
+    std::uint32_t h = hashStart(seed);
+    for (std::size_t i = 0; i < s.size();) h = hashStep(h, decodeUtf8(s, i));
+    return hashFinish(h);
+}
+
+constexpr std::uint32_t hashKey(std::u16string_view s, std::uint32_t seed) {
+    std::uint32_t h = hashStart(seed);
+    for (std::size_t i = 0; i < s.size();) h = hashStep(h, decodeUtf16(s, i));
+    return hashFinish(h);
+}
+
+constexpr bool keyEquals(std::string_view key, std::string_view s) { return key == s; }
+
+constexpr bool keyEquals(std::string_view key, std::u16string_view s) {
+    std::size_t i = 0, j = 0;
+    while (i < key.size() && j < s.size())
+        if (decodeUtf8(key, i) != decodeUtf16(s, j)) return false;
+    return i == key.size() && j == s.size();
+}
+
+// Perfect hash (hash-and-displace): keys are bucketed by their
+// seed-0 hash, and each bucket gets its own seed that maps all of its keys
+// to free slots. Built entirely at compile time.
+template <std::size_t Buckets, std::size_t Slots>
+struct PerfectHash {
+    std::array<std::uint16_t, Buckets> seeds{};
+    std::array<std::uint16_t, Slots> slots{}; // key index + 1, 0 = empty
+
+    template <typename Key>
+    constexpr int find(const Key &key) const {
+        std::uint32_t seed = seeds[hashKey(key, 0) & (Buckets - 1)];
+        return static_cast<int>(slots[hashKey(key, seed) & (Slots - 1)]) - 1;
+    }
+};
+
+template <std::size_t Buckets, std::size_t Slots, std::size_t N>
+constexpr PerfectHash<Buckets, Slots> buildPerfectHash(const std::array<std::string_view, N> &keys) {
+    PerfectHash<Buckets, Slots> ph{};
+    std::array<std::uint16_t, N> bucketOf{};
+    std::array<std::uint16_t, Buckets> bucketSize{};
+    std::size_t largest = 0;
+    for (std::size_t k = 0; k < N; ++k) {
+        bucketOf[k] = static_cast<std::uint16_t>(hashKey(keys[k], 0) & (Buckets - 1));
+        if (++bucketSize[bucketOf[k]] > largest) largest = bucketSize[bucketOf[k]];
+    }
+    // Place the largest buckets first while the table is still sparse.
+    for (std::size_t size = largest; size > 0; --size) {
+        for (std::size_t b = 0; b < Buckets; ++b) {
+            if (bucketSize[b] != size) continue;
+            bool placed = false;
+            for (std::uint32_t seed = 1; seed < 0xFFFF && !placed; ++seed) {
+                std::array<std::size_t, N> taken{};
+                std::size_t n = 0;
+                bool ok = true;
+                for (std::size_t k = 0; k < N && ok; ++k) {
+                    if (bucketOf[k] != b) continue;
+                    std::size_t slot = hashKey(keys[k], seed) & (Slots - 1);
+                    if (ph.slots[slot] != 0) ok = false;
+                    for (std::size_t t = 0; t < n && ok; ++t)
+                        if (taken[t] == slot) ok = false;
+                    taken[n++] = slot;
+                }
+                if (!ok) continue;
+                n = 0;
+                for (std::size_t k = 0; k < N; ++k)
+                    if (bucketOf[k] == b) ph.slots[taken[n++]] = static_cast<std::uint16_t>(k + 1);
+                ph.seeds[b] = static_cast<std::uint16_t>(seed);
+                placed = true;
+            }
+            if (!placed) throw "perfect hash construction failed";
+        }
+    }
+    return ph;
 }
 
+constexpr std::size_t countRows() {
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < CellCount; ++i)
+        if (i == 0 || Cells[i].script != Cells[i - 1].script || Cells[i].row != Cells[i - 1].row) ++rows;
+    return rows;
+}
+
+constexpr std::array<RowSpan, countRows()> buildRows() {
+    std::array<RowSpan, countRows()> rows{};
+    std::size_t r = 0;
+    for (std::size_t i = 0; i < CellCount; ++i) {
+        if (i > 0 && (Cells[i].script != Cells[i - 1].script || Cells[i].row != Cells[i - 1].row)) ++r;
+        if (rows[r].cellCount == 0) rows[r].firstCell = static_cast<std::uint16_t>(i);
+        ++rows[r].cellCount;
+    }
+    return rows;
+}
+
+constexpr std::array<ScriptInfo, ScriptCount> buildScripts() {
+    std::array<ScriptInfo, ScriptCount> scripts{};
+    std::size_t row = 0;
+    for (std::size_t i = 0; i < CellCount; ++i) {
+        ScriptInfo &s = scripts[static_cast<std::size_t>(Cells[i].script)];
+        bool newRow = i == 0 || Cells[i].script != Cells[i - 1].script || Cells[i].row != Cells[i - 1].row;
+        if (newRow && i > 0) ++row;
+        if (s.cellCount == 0) {
+            s.firstCell = static_cast<std::uint16_t>(i);
+            s.firstRow = static_cast<std::uint16_t>(row);
+        }
+        ++s.cellCount;
+        if (newRow) ++s.rowCount;
+        if (Cells[i].col + 1u > s.columnCount) s.columnCount = static_cast<std::uint16_t>(Cells[i].col + 1u);
+    }
+    return scripts;
+}
+
+constexpr std::array<std::string_view, CellCount> kanaKeys() {
+    std::array<std::string_view, CellCount> keys{};
+    for (std::size_t i = 0; i < CellCount; ++i) keys[i] = Cells[i].kana;
+    return keys;
+}
+
+constexpr bool firstWithRomaji(std::size_t i) {
+    for (std::size_t j = 0; j < i; ++j)
+        if (Cells[j].romaji == Cells[i].romaji) return false;
+    return true;
+}
+
+constexpr std::size_t countRomajiKeys() {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < CellCount; ++i)
+        if (firstWithRomaji(i)) ++n;
+    return n;
+}
+
+constexpr std::uint32_t tableFingerprint() {
+    std::uint32_t h = hashStart(0);
+    for (std::size_t i = 0; i < CellCount; ++i) {
+        h = hashStep(h, hashKey(Cells[i].kana, 0));
+        h = hashStep(h, hashKey(Cells[i].romaji, 0));
+    }
+    return hashFinish(h);
+}
+
+} // namespace detail
+
+// Changes whenever the tables change, i.e. whenever CharIds may shift.
+// Anything that persists raw CharIds must check it.
+inline constexpr std::uint32_t TableFingerprint = detail::tableFingerprint();
+
+inline constexpr auto Rows = detail::buildRows();
+inline constexpr auto Scripts = detail::buildScripts();
+
+constexpr const ScriptInfo &scriptInfo(Script script) { return Scripts[static_cast<std::size_t>(script)]; }
+constexpr const RowSpan &rowSpan(Script script, int row) { return Rows[scriptInfo(script).firstRow + row]; }
+
+// Distinct romaji strings, each mapping to a run of RomajiChars.
+struct RomajiKey {
+    std::string_view romaji;
+    std::uint16_t first;
+    std::uint16_t count;
+};
+
+inline constexpr std::size_t RomajiKeyCount = detail::countRomajiKeys();
+
+namespace detail {
+
+struct RomajiIndex {
+    std::array<RomajiKey, RomajiKeyCount> keys{};
+    std::array<CharId, CellCount> chars{};
+};
+
+constexpr RomajiIndex buildRomajiIndex() {
+    RomajiIndex index{};
+    std::size_t k = 0, c = 0;
+    for (std::size_t i = 0; i < CellCount; ++i) {
+        if (!firstWithRomaji(i)) continue;
+        index.keys[k] = {Cells[i].romaji, static_cast<std::uint16_t>(c), 0};
+        for (std::size_t j = i; j < CellCount; ++j) {
+            if (Cells[j].romaji != Cells[i].romaji) continue;
+            index.chars[c++] = static_cast<CharId>(j);
+            ++index.keys[k].count;
+        }
+        ++k;
+    }
+    return index;
+}
+
+constexpr std::array<std::string_view, RomajiKeyCount> romajiKeys(const RomajiIndex &index) {
+    std::array<std::string_view, RomajiKeyCount> keys{};
+    for (std::size_t i = 0; i < RomajiKeyCount; ++i) keys[i] = index.keys[i].romaji;
+    return keys;
+}
+
+inline constexpr RomajiIndex Romaji = buildRomajiIndex();
+
+inline constexpr auto KanaHash = buildPerfectHash<nextPow2(CellCount / 2), nextPow2(CellCount * 2)>(kanaKeys());
+inline constexpr auto RomajiHash = buildPerfectHash<nextPow2(RomajiKeyCount / 2), nextPow2(RomajiKeyCount * 2)>(romajiKeys(Romaji));
+
+} // namespace detail
+
+namespace detail {
+
+template <typename Str>
+constexpr CharId findKana(Str kana) {
+    int k = KanaHash.find(kana);
+    return k >= 0 && keyEquals(Cells[k].kana, kana) ? static_cast<CharId>(k) : InvalidChar;
+}
+
+template <typename Str>
+constexpr CharSpan findRomaji(Str romaji) {
+    int k = RomajiHash.find(romaji);
+    if (k < 0 || !keyEquals(Romaji.keys[k].romaji, romaji)) return {};
+    const RomajiKey &key = Romaji.keys[k];
+    return {Romaji.chars.data() + key.first, key.count};
+}
+
+} // namespace detail
+
+// O(1) kana -> CharId. Returns InvalidChar if the kana is not in any table.
+constexpr CharId findKana(std::string_view kana) { return detail::findKana(kana); }
+constexpr CharId findKana(std::u16string_view kana) { return detail::findKana(kana); }
+
+// O(1) romaji -> every CharId read that way (e.g. "ji" -> じ, ぢ, ジ, ヂ).
+constexpr CharSpan findRomaji(std::string_view romaji) { return detail::findRomaji(romaji); }
+constexpr CharSpan findRomaji(std::u16string_view romaji) { return detail::findRomaji(romaji); }
+
+static_assert(Cells[findKana(std::string_view(u8"ぢ"))].romaji == "ji", "kana perfect hash");
+static_assert(findRomaji(std::string_view("ji")).count == 4, "romaji perfect hash");
+
+CharId findKana(QStringView kana);
+CharSpan findRomaji(QStringView romaji);
+bool romajiEquals(CharId id, QStringView romaji);
+QString kanaText(CharId id);
+QString romajiText(CharId id);
+// True if `typed` is `expected` or kana of the same script that spell the
+// same romaji (じ for ぢ, ヲ for ウォ), which a romaji prompt cannot tell apart.
+bool sameReading(QStringView expected, QStringView typed);
+
+} // namespace AlphabetData
+
 #endif // ALPHABETDATA_H
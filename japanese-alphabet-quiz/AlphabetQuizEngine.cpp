@@ -0,0 +1,229 @@
+#include "AlphabetQuizEngine.h"
+#include "Romanizer.h"
+#include "SessionRandom.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Loaded counts are clamped to [0, MaxErrorCount]: they come from a file or
+// the database as stored, and a negative one would wrap to a huge draw
+// weight. The cap is far above what practice reaches.
+constexpr int MaxErrorCount = 1 << 20;
+}
+
+AlphabetQuizEngine::AlphabetQuizEngine(QObject *parent) : QObject(parent) {
+}
+
+void AlphabetQuizEngine::setConfig(const AlphabetQuizConfig &config) {
+    bool newWeighting = config.weightedPractice != cfg.weightedPractice;
+    bool newDirection = config.typeKana != cfg.typeKana;
+    cfg = config;
+    if (newDirection) {
+        // Enabled kanji leave the running round in kana mode and rejoin it after
+        for (CharId id = 0; id < AlphabetData::CellCount; ++id) {
+            if (!enabled[id] || AlphabetData::Cells[id].script != AlphabetData::Script::Kanji) continue;
+            pool.setCount(id, asks(id) ? cfg.timesToShow : 0);
+            emit cellMarked(id, Mark::Cleared);
+        }
+    }
+    if (newWeighting)
+        refreshWeights();
+}
+
+bool AlphabetQuizEngine::asks(CharId id) const {
+    // A kanji's reading is the kana of its romaji, so typing kana would not test the kanji
+    return enabled[id] && !(cfg.typeKana && AlphabetData::Cells[id].script == AlphabetData::Script::Kanji);
+}
+
+bool AlphabetQuizEngine::hasAskedChars() const {
+    for (CharId id = 0; id < AlphabetData::CellCount; ++id)
+        if (asks(id)) return true;
+    return false;
+}
+
+std::vector<AlphabetData::CharId> AlphabetQuizEngine::enabledCharList() const {
+    std::vector<CharId> ids;
+    ids.reserve(enabled.count());
+    for (CharId id = 0; id < AlphabetData::CellCount; ++id)
+        if (enabled[id]) ids.push_back(id);
+    return ids;
+}
+
+void AlphabetQuizEngine::setEnabledChars(const CharSet &chars) {
+    enabled = chars;
+}
+
+// Newly enabled cells join the current round with a full count; disabled
+// cells drop out of it. Cells that keep their state are left alone.
+void AlphabetQuizEngine::setCellsEnabled(int firstCell, int cellCount, bool on) {
+    for (int i = firstCell; i < firstCell + cellCount; ++i) {
+        CharId id = static_cast<CharId>(i);
+        if (enabled[id] == on) continue;
+        enabled[id] = on;
+        pool.setCount(id, asks(id) ? cfg.timesToShow : 0);
+        emit cellMarked(id, Mark::Cleared);
+    }
+}
+
+void AlphabetQuizEngine::newRound() {
+    pool.reset(AlphabetData::CellCount);
+    answeredOnce.reset();
+    charStatsCorrect.fill(0);
+    charStatsIncorrect.fill(0);
+    for (CharId id = 0; id < AlphabetData::CellCount; ++id)
+        if (asks(id)) pool.setCount(id, cfg.timesToShow);
+    refreshWeights();
+    correct = 0;
+    retries = 0;
+    emit roundStarted();
+}
+
+AlphabetQuizEngine::Draw AlphabetQuizEngine::nextQuestion(bool avoidRepeat) {
+    if (!hasAskedChars()) return Draw::NothingEnabled;
+    if (pool.empty()) return Draw::RoundComplete;
+    bool exclude = avoidRepeat && currentChar != AlphabetData::InvalidChar;
+    currentChar = static_cast<CharId>(pool.draw(SessionRandom::engine(), exclude ? currentChar : RoundPool::NoItem));
+    currentReading = reading(currentChar);
+    return Draw::Drawn;
+}
+
+bool AlphabetQuizEngine::answer(const QString &input) {
+    if (currentChar == AlphabetData::InvalidChar) return false;
+    CharId id = currentChar;
+    bool right = cfg.typeKana ? AlphabetData::sameReading(currentReading, QStringView(input).trimmed())
+                              : Romanizer::accepts(currentReading, input);
+    if (right) {
+        correct++;
+        answeredOnce.set(id);
+        charStatsCorrect[id]++;
+        // The last occurrence of a character completes it for this round
+        if (pool.take(id) && pool.remaining(id) == 0)
+            emit cellMarked(id, Mark::Completed);
+        // Decrease error count by 1 (min 0) on correct answer
+        if (errorStats[id] > 0) {
+            errorStats[id]--;
+            pool.setMultiplier(id, weightMultiplier(id));
+            recordErrorDelta(id, -1);
+        }
+        return true;
+    }
+    retries++;
+    charStatsIncorrect[id]++;
+    // Increase error count by 2 on incorrect answer
+    errorStats[id] += 2;
+    pool.setMultiplier(id, weightMultiplier(id));
+    recordErrorDelta(id, 2);
+    emit cellMarked(id, Mark::Missed);
+    return false;
+}
+
+AnswerTrie::Progress AlphabetQuizEngine::liveProgress(QStringView input) const {
+    if (currentChar == AlphabetData::InvalidChar) return AnswerTrie::Progress::Mismatch;
+    if (!cfg.typeKana) return Romanizer::progress(currentReading, input);
+    // Typed kana may end in romaji that has not been converted yet
+    QStringView typed = input.trimmed();
+    qsizetype kana = typed.size();
+    while (kana > 0 && typed[kana - 1].unicode() < 0x80) --kana;
+    QStringView done = typed.first(kana);
+    if (AlphabetData::sameReading(currentReading, done))
+        return kana == typed.size() ? AnswerTrie::Progress::UniqueComplete : AnswerTrie::Progress::Mismatch;
+    if (done.size() < currentReading.size() && AlphabetData::sameReading(QStringView(currentReading).first(done.size()), done))
+        return AnswerTrie::Progress::Prefix;
+    return AnswerTrie::Progress::Mismatch;
+}
+
+QString AlphabetQuizEngine::reading(CharId id) {
+    if (AlphabetData::Cells[id].script == AlphabetData::Script::Kanji)
+        return Romanizer::toKana(AlphabetData::romajiText(id));
+    return AlphabetData::kanaText(id);
+}
+
+AlphabetQuizEngine::RoundSummary AlphabetQuizEngine::roundSummary() const {
+    RoundSummary summary;
+    for (CharId id = 0; id < AlphabetData::CellCount; ++id) {
+        if (!asks(id)) continue;
+        int incorrect = charStatsIncorrect[id];
+        if (incorrect > 0) {
+            ++summary.wrong;
+            if (incorrect > 1) summary.hard.push_back(id);
+        } else {
+            ++summary.right;
+        }
+    }
+    return summary;
+}
+
+// --- Error stats persistence ---
+// The snapshot is persisted as {"kana|romaji": count} in the profile JSON;
+// changes since the last snapshot live in the append-only journal.
+void AlphabetQuizEngine::loadErrorStats(const QJsonObject &stats, const QJsonObject &journalMark) {
+    errorStats.fill(0);
+    for (auto it = stats.begin(); it != stats.end(); ++it) {
+        QString key = it.key();
+        int sep = key.indexOf("|");
+        if (sep <= 0) continue;
+        CharId id = AlphabetData::findKana(QStringView(key).left(sep));
+        if (id != AlphabetData::InvalidChar && AlphabetData::romajiEquals(id, QStringView(key).mid(sep + 1)))
+            errorStats[id] = std::clamp(it.value().toInt(), 0, MaxErrorCount);
+    }
+    journal.replay(errorStats, static_cast<quint32>(journalMark["generation"].toDouble()), journalMark["bytes"].toInteger());
+    for (int &count : errorStats) count = std::clamp(count, 0, MaxErrorCount);
+    refreshWeights();
+}
+
+QJsonObject AlphabetQuizEngine::errorStatsJson() const {
+    QJsonObject obj;
+    for (CharId id = 0; id < AlphabetData::CellCount; ++id) {
+        if (errorStats[id] == 0) continue;
+        obj[errorStatsKey(id)] = errorStats[id];
+    }
+    return obj;
+}
+
+QString AlphabetQuizEngine::errorStatsKey(CharId id) {
+    return AlphabetData::kanaText(id) + "|" + AlphabetData::romajiText(id);
+}
+
+void AlphabetQuizEngine::recordErrorDelta(CharId id, int delta) {
+    if (errorCountSink) {
+        errorCountSink(id, errorStats[id]);
+        return;
+    }
+    if (!journal.append(id, delta) || journal.needsCompaction())
+        compactErrorStats();
+}
+
+// Folds the journal into the profile snapshot. The sink makes the snapshot
+// durable before the journal is dropped; if we crash in between, the journal
+// mark in the snapshot keeps those records from being applied twice.
+void AlphabetQuizEngine::compactErrorStats() {
+    if (!snapshotSink) return;
+    QJsonObject mark;
+    mark["generation"] = static_cast<double>(journal.generation());
+    mark["bytes"] = journal.size();
+    // Until the snapshot is saved, the journal is the only durable copy of its deltas
+    if (!snapshotSink(errorStatsJson(), mark)) {
+        qDebug() << "Keeping the error stats journal; the snapshot was not saved";
+        return;
+    }
+    journal.clear();
+}
+
+void AlphabetQuizEngine::resetErrorStats() {
+    errorStats.fill(0);
+    refreshWeights();
+    compactErrorStats();
+}
+
+// Each remaining occurrence weighs 1, or 1 + 3 per error when practising
+// hard characters more often.
+std::uint64_t AlphabetQuizEngine::weightMultiplier(CharId id) const {
+    return cfg.weightedPractice ? 1 + 3 * static_cast<std::uint64_t>(errorStats[id]) : 1;
+}
+
+void AlphabetQuizEngine::refreshWeights() {
+    std::vector<std::uint64_t> multipliers(AlphabetData::CellCount);
+    for (CharId id = 0; id < AlphabetData::CellCount; ++id)
+        multipliers[id] = weightMultiplier(id);
+    pool.setMultipliers(multipliers);
+}
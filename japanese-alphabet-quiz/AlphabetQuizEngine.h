@@ -0,0 +1,123 @@
+#ifndef ALPHABETQUIZENGINE_H
+#define ALPHABETQUIZENGINE_H
+#include <QObject>
+#include <QJsonObject>
+#include <QStringList>
+#include <array>
+#include <bitset>
+#include <functional>
+#include <vector>
+#include "AlphabetData.h"
+#include "AnswerTrie.h"
+#include "ErrorStatsJournal.h"
+#include "RoundPool.h"
+
+struct AlphabetQuizConfig {
+    int timesToShow = 1;       // occurrences of each enabled character per round
+    bool weightedPractice = false; // draw characters with errors more often
+    bool typeKana = false;         // show the romaji and have the kana typed; kanji are not asked
+};
+
+// Widget-free alphabet quiz session: which characters are enabled, the
+// current round, scoring and the persistent error stats. Front ends feed it
+// selections and answers and react to its signals.
+class AlphabetQuizEngine : public QObject {
+    Q_OBJECT
+public:
+    using CharId = AlphabetData::CharId;
+    using CharSet = std::bitset<AlphabetData::CellCount>;
+    using CharCounters = std::array<int, AlphabetData::CellCount>;
+
+    enum class Draw { Drawn, NothingEnabled, RoundComplete };
+    enum class Mark { Cleared, Completed, Missed };
+
+    struct RoundSummary {
+        int right = 0;
+        int wrong = 0;
+        std::vector<CharId> hard; // missed more than once
+    };
+
+    // Persists an error-stats snapshot and the journal mark it covers. It
+    // must be durable on return, since the journal is dropped afterwards.
+    // Returns false if it could not, and the journal is then kept.
+    using SnapshotSink = std::function<bool(const QJsonObject &stats, const QJsonObject &journalMark)>;
+    // Receives each changed count in place of the journal, e.g. to update one database row.
+    using ErrorCountSink = std::function<void(CharId id, int errors)>;
+
+    explicit AlphabetQuizEngine(QObject *parent = nullptr);
+
+    const AlphabetQuizConfig &config() const { return cfg; }
+    // The repeat count applies from the next round; weighting and which
+    // cells typeKana asks apply at once.
+    void setConfig(const AlphabetQuizConfig &config);
+
+    const CharSet &enabledChars() const { return enabled; }
+    std::vector<CharId> enabledCharList() const;
+    // Replaces the selection; takes effect at the next newRound().
+    void setEnabledChars(const CharSet &chars);
+    // Enables or disables a span of cells and adjusts the running round.
+    void setCellsEnabled(int firstCell, int cellCount, bool on);
+    // True if the current mode asks `id`: it is enabled, and not a kanji
+    // while kana are typed.
+    bool asks(CharId id) const;
+    bool hasAskedChars() const;
+
+    void newRound();
+    Draw nextQuestion(bool avoidRepeat = false);
+    CharId current() const { return currentChar; }
+    bool roundComplete() const { return pool.empty(); }
+    int totalRemaining() const { return static_cast<int>(pool.totalRemaining()); }
+    // The kana that answer the current character: itself, or a kanji's reading.
+    const QString &currentKana() const { return currentReading; }
+    // Checks an answer for the current character and updates scores and stats.
+    // Any Hepburn, Kunrei or Nihon-shiki spelling is accepted (し: shi or si);
+    // with typeKana, the kana or one read the same (ぢ for じ).
+    bool answer(const QString &input);
+    // Live feedback for the current character while the answer is typed.
+    AnswerTrie::Progress liveProgress(QStringView input) const;
+    int correctCount() const { return correct; }
+    int retryCount() const { return retries; }
+    RoundSummary roundSummary() const;
+
+    int errorCount(CharId id) const { return errorStats[id]; }
+    void setSnapshotSink(SnapshotSink sink) { snapshotSink = std::move(sink); }
+    void setJournalPath(const QString &path) { journal.setPath(path); }
+    void setErrorCountSink(ErrorCountSink sink) { errorCountSink = std::move(sink); }
+    // Loads the profile snapshot and replays the journal on top of it.
+    void loadErrorStats(const QJsonObject &stats, const QJsonObject &journalMark);
+    void resetErrorStats();
+    // Writes a snapshot through the sink and drops the journal.
+    void compactErrorStats();
+    QJsonObject errorStatsJson() const;
+    // "kana|romaji", the key a character's count is stored under
+    static QString errorStatsKey(CharId id);
+    // The kana whose spellings answer a character; a kanji is read through
+    // the kana of its romaji, so 日 takes niti as well as nichi.
+    static QString reading(CharId id);
+
+signals:
+    void cellMarked(AlphabetData::CharId id, AlphabetQuizEngine::Mark mark);
+    void roundStarted();
+
+private:
+    std::uint64_t weightMultiplier(CharId id) const;
+    void refreshWeights();
+    void recordErrorDelta(CharId id, int delta);
+
+    AlphabetQuizConfig cfg;
+    CharSet enabled;
+    RoundPool pool{AlphabetData::CellCount}; // occurrences left this round
+    CharId currentChar = AlphabetData::InvalidChar;
+    QString currentReading; // kana of the current character
+    int correct = 0;
+    int retries = 0;
+    CharSet answeredOnce;
+    CharCounters charStatsCorrect{};
+    CharCounters charStatsIncorrect{};
+    CharCounters errorStats{};
+    ErrorStatsJournal journal;
+    SnapshotSink snapshotSink;
+    ErrorCountSink errorCountSink;
+};
+
+#endif // ALPHABETQUIZENGINE_H
@@ -0,0 +1,201 @@
+#include "AnswerMatcher.h"
+#include "DeckStore.h"
+#include "Romanizer.h"
+#include <algorithm>
+
+namespace {
+const QStringView Separator = u" / ";
+
+DeckStore::Field fieldFor(AnswerMatcher::Kind kind) {
+    return kind == AnswerMatcher::Romaji ? DeckStore::Romaji : DeckStore::English;
+}
+
+QStringView readingOf(const DeckStore &store, WordId id) {
+    QStringView kana = store.field(id, DeckStore::Hiragana);
+    return kana.isEmpty() ? store.field(id, DeckStore::Katakana) : kana;
+}
+}
+
+void AnswerMatcher::build(const DeckStore &store) {
+    clear();
+    for (WordId id = 0; id < WordId(store.wordCount()); ++id) {
+        for (Kind kind : {Romaji, English}) {
+            first.push_back(std::uint32_t(entries.size()));
+            QStringView field = store.field(id, fieldFor(kind));
+            // Same split as before: every " / " separates two alternatives
+            qsizetype from = 0;
+            for (qsizetype sep; (sep = field.indexOf(Separator, from)) >= 0; from = sep + Separator.size())
+                insert(id, kind, field.mid(from, sep - from));
+            insert(id, kind, field.mid(from));
+        }
+    }
+    first.push_back(std::uint32_t(entries.size()));
+    refreshView();
+    // Options first: they read the alternatives, which appending kana may move
+    std::vector<unsigned> options(std::size_t(store.wordCount()));
+    for (WordId id = 0; id < WordId(store.wordCount()); ++id)
+        options[id] = readingOptions(id, readingOf(store, id));
+    readings.reserve(store.wordCount());
+    for (WordId id = 0; id < WordId(store.wordCount()); ++id) {
+        QStringView kana = readingOf(store, id);
+        readings.push_back({std::uint32_t(text.size()), std::uint32_t(kana.size()), options[id]});
+        text.insert(text.end(), kana.utf16(), kana.utf16() + kana.size());
+    }
+    text.shrink_to_fit();
+    entries.shrink_to_fit();
+    first.shrink_to_fit();
+    trie.squeeze();
+    refreshView();
+}
+
+void AnswerMatcher::clear() {
+    text = {};
+    entries = {};
+    first = {};
+    slots = {};
+    readings = {};
+    trie.clear();
+    view = View();
+}
+
+void AnswerMatcher::adopt(const View &mapped) {
+    clear();
+    view = mapped;
+    trie.adopt(mapped.trie);
+}
+
+void AnswerMatcher::refreshView() {
+    view.text = text.data();
+    view.textUnits = std::uint32_t(text.size());
+    view.entries = entries.data();
+    view.entryCount = std::uint32_t(entries.size());
+    view.first = first.data();
+    view.firstCount = std::uint32_t(first.size());
+    view.slots = slots.data();
+    view.slotCount = std::uint32_t(slots.size());
+    view.readings = readings.data();
+    view.readingCount = std::uint32_t(readings.size());
+    view.trie = trie.arrays();
+}
+
+std::size_t AnswerMatcher::hash(std::uint32_t word, Kind kind, QStringView s) {
+    // FNV-1a over the word, kind and folded text
+    std::uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](std::uint32_t v) { h = (h ^ v) * 1099511628211ull; };
+    mix(word);
+    mix(kind);
+    for (QChar c : s) mix(fold(c.unicode()));
+    return std::size_t(h ^ (h >> 32));
+}
+
+bool AnswerMatcher::matches(std::uint32_t word, Kind kind, QStringView answer) const {
+    if (listed(word, kind, answer)) return true;
+    return kind == Romaji && Romanizer::accepts(kana(word), answer, readingOptions(word));
+}
+
+// Particle readings only where the deck itself uses one (こんにちは as
+// konnichiwa), so はは is not "hawa"
+unsigned AnswerMatcher::readingOptions(std::uint32_t word, QStringView kana) const {
+    if (!kana.contains(u'は') && !kana.contains(u'へ') && !kana.contains(u'ハ') && !kana.contains(u'ヘ'))
+        return Romanizer::None;
+    for (int i = 0, n = alternativeCount(word, Romaji); i < n; ++i) {
+        QStringView alt = alternative(word, Romaji, i);
+        if (!Romanizer::accepts(kana, alt) && Romanizer::accepts(kana, alt, Romanizer::ParticleReadings))
+            return Romanizer::ParticleReadings;
+    }
+    return Romanizer::None;
+}
+
+unsigned AnswerMatcher::readingOptions(std::uint32_t word) const {
+    return word < view.readingCount ? view.readings[word].options : Romanizer::None;
+}
+
+// A trie result and a Romanizer result together: complete if either is, and
+// unique only if nothing in either goes on from the input
+AnswerTrie::Progress AnswerMatcher::progress(std::uint32_t word, Kind kind, QStringView input) const {
+    using Progress = AnswerTrie::Progress;
+    input = input.trimmed(); // as matches() reads it
+    Progress listedProgress = trie.progress(2 * word + kind, input);
+    if (kind != Romaji || kana(word).isEmpty()) return listedProgress;
+    Progress spelled = Romanizer::progress(kana(word), input, readingOptions(word));
+    if (listedProgress == Progress::Mismatch) return spelled;
+    if (spelled == Progress::Mismatch) return listedProgress;
+    auto isComplete = [](Progress p) { return p == Progress::Complete || p == Progress::UniqueComplete; };
+    if (!isComplete(listedProgress) && !isComplete(spelled)) return Progress::Prefix;
+    return listedProgress == Progress::UniqueComplete && spelled == Progress::UniqueComplete ? Progress::UniqueComplete
+                                                                                              : Progress::Complete;
+}
+
+QStringView AnswerMatcher::kana(std::uint32_t word) const {
+    if (word >= view.readingCount) return {};
+    return textAt(view.readings[word].offset, view.readings[word].length);
+}
+
+QStringView AnswerMatcher::textAt(std::uint32_t offset, std::uint32_t length) const {
+    if (std::uint64_t(offset) + length > view.textUnits) return {};
+    return QStringView(view.text + offset, qsizetype(length));
+}
+
+bool AnswerMatcher::listed(std::uint32_t word, Kind kind, QStringView answer) const {
+    if (view.slotCount == 0) return false;
+    answer = answer.trimmed();
+    const std::size_t mask = view.slotCount - 1;
+    std::size_t i = hash(word, kind, answer) & mask;
+    for (std::uint32_t probes = 0; probes < view.slotCount; ++probes, i = (i + 1) & mask) {
+        std::uint32_t slot = view.slots[i];
+        if (slot == 0 || slot > view.entryCount) return false;
+        const Entry &e = view.entries[slot - 1];
+        if (e.word != word || e.kind != kind || e.length != std::uint32_t(answer.size())) continue;
+        QStringView stored = textAt(e.offset, e.length);
+        if (stored.size() == answer.size()
+            && std::equal(answer.begin(), answer.end(), stored.begin(),
+                          [](QChar a, QChar b) { return fold(a.unicode()) == b.unicode(); }))
+            return true;
+    }
+    return false;
+}
+
+int AnswerMatcher::alternativeCount(std::uint32_t word, Kind kind) const {
+    std::size_t i = 2 * std::size_t(word) + kind;
+    if (i + 1 >= view.firstCount || view.first[i + 1] > view.entryCount || view.first[i] > view.first[i + 1]) return 0;
+    return int(view.first[i + 1] - view.first[i]);
+}
+
+QStringView AnswerMatcher::alternative(std::uint32_t word, Kind kind, int index) const {
+    const Entry &e = view.entries[view.first[2 * std::size_t(word) + kind] + index];
+    return textAt(e.offset, e.length);
+}
+
+void AnswerMatcher::insert(std::uint32_t word, Kind kind, QStringView alternative) {
+    alternative = alternative.trimmed();
+    if (listed(word, kind, alternative)) return; // listed twice
+    if ((entries.size() + 1) * 2 > slots.size()) growTable();
+    Entry e{word, kind, std::uint32_t(text.size()), std::uint32_t(alternative.size())};
+    for (QChar c : alternative) text.push_back(fold(c.unicode()));
+    entries.push_back(e);
+    trie.insert(2 * word + kind, QStringView(text.data() + e.offset, qsizetype(e.length)));
+    const std::size_t mask = slots.size() - 1;
+    std::size_t i = hash(word, kind, alternative) & mask;
+    while (slots[i] != 0) i = (i + 1) & mask;
+    slots[i] = std::uint32_t(entries.size());
+    refreshView(); // the next insert's duplicate check reads through the view
+}
+
+void AnswerMatcher::growTable() {
+    std::vector<std::uint32_t> grown(std::max<std::size_t>(64, slots.size() * 2), 0);
+    const std::size_t mask = grown.size() - 1;
+    for (std::size_t n = 0; n < entries.size(); ++n) {
+        const Entry &e = entries[n];
+        QStringView s(text.data() + e.offset, qsizetype(e.length));
+        std::size_t i = hash(e.word, Kind(e.kind), s) & mask;
+        while (grown[i] != 0) i = (i + 1) & mask;
+        grown[i] = std::uint32_t(n + 1);
+    }
+    slots = std::move(grown);
+}
+
+std::size_t AnswerMatcher::memoryUsage() const {
+    return text.capacity() * sizeof(char16_t) + entries.capacity() * sizeof(Entry)
+         + (first.capacity() + slots.capacity()) * sizeof(std::uint32_t) + readings.capacity() * sizeof(Reading)
+         + trie.memoryUsage();
+}
@@ -0,0 +1,109 @@
+#ifndef ANSWERMATCHER_H
+#define ANSWERMATCHER_H
+#include <QChar>
+#include <QStringView>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AnswerTrie.h"
+
+class DeckStore;
+
+// Accepted answers of every word in a DeckStore, normalized once when the
+// decks finish loading. A field such as "Ohayou / ohayō" is split on " / ",
+// and each alternative is trimmed and lower-cased into one arena. The
+// results sit in an open-addressed table keyed by (word, kind, text).
+// A check trims the input and lower-cases it while hashing, so it is one
+// probe sequence with no allocation, however many alternatives the word has.
+// The same alternatives also fill a prefix trie for live feedback.
+// Romaji answers are also run through the Romanizer against the word's
+// kana, so Kunrei spellings and long-vowel variants need not be listed.
+// は and へ are read wa and e only in words whose listed romaji does so.
+//
+// The index is flat arrays, so VocabularyCache stores it next to the decks
+// and a cached open adopts it as mapped instead of building it again.
+class AnswerMatcher {
+public:
+    enum Kind : std::uint8_t { Romaji, English };
+    struct Entry {
+        std::uint32_t word;
+        std::uint32_t kind;
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+    struct Reading {
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::uint32_t options; // Romanizer options the word's spellings are checked with
+    };
+    // The arrays a matcher reads, laid out as the cache stores them
+    struct View {
+        const char16_t *text = nullptr; // folded alternatives, then each word's kana as is
+        std::uint32_t textUnits = 0;
+        const Entry *entries = nullptr;
+        std::uint32_t entryCount = 0;
+        // Entries of (word, kind) are [first[2 * word + kind], first[2 * word + kind + 1])
+        const std::uint32_t *first = nullptr;
+        std::uint32_t firstCount = 0;
+        // slot = entry index + 1, 0 = empty; count is a power of two
+        const std::uint32_t *slots = nullptr;
+        std::uint32_t slotCount = 0;
+        const Reading *readings = nullptr; // kana of each word, empty if it has none
+        std::uint32_t readingCount = 0;
+        AnswerTrie::View trie;
+    };
+
+    AnswerMatcher() = default;
+    // The view points into the owned arrays, which a move keeps in place
+    AnswerMatcher(AnswerMatcher &&) noexcept = default;
+    AnswerMatcher &operator=(AnswerMatcher &&) noexcept = default;
+    AnswerMatcher(const AnswerMatcher &) = delete;
+    AnswerMatcher &operator=(const AnswerMatcher &) = delete;
+
+    void build(const DeckStore &store);
+    void clear();
+    // Serves arrays owned elsewhere (a mapped cache); they must outlive the
+    // matcher's use. Mapped offsets are bounds-checked on every read.
+    void adopt(const View &mapped);
+    const View &arrays() const { return view; }
+    // True if `answer`, ignoring case and surrounding spaces, is one of the
+    // word's alternatives for `kind`, or for romaji a spelling of its kana.
+    bool matches(std::uint32_t word, Kind kind, QStringView answer) const;
+    // How far `input` is along one of the word's answers, for live feedback.
+    AnswerTrie::Progress progress(std::uint32_t word, Kind kind, QStringView input) const;
+    // The word's alternatives for `kind`, already folded; for near-miss checks.
+    int alternativeCount(std::uint32_t word, Kind kind) const;
+    QStringView alternative(std::uint32_t word, Kind kind, int index) const;
+    // The word's reading as written: its hiragana, else its katakana.
+    QStringView kana(std::uint32_t word) const;
+    std::size_t alternativeCount() const { return view.entryCount; }
+    std::size_t memoryUsage() const;
+
+    // Per-unit lower-casing, so folded text keeps its length and input can
+    // be folded while it is hashed and compared.
+    static char16_t fold(char16_t c) {
+        if (c < 0x80) return (c >= u'A' && c <= u'Z') ? char16_t(c + 32) : c;
+        return QChar(c).toLower().unicode();
+    }
+
+private:
+    static std::size_t hash(std::uint32_t word, Kind kind, QStringView text);
+    unsigned readingOptions(std::uint32_t word, QStringView kana) const;
+    unsigned readingOptions(std::uint32_t word) const;
+    QStringView textAt(std::uint32_t offset, std::uint32_t length) const;
+    bool listed(std::uint32_t word, Kind kind, QStringView answer) const;
+    void insert(std::uint32_t word, Kind kind, QStringView alternative);
+    void growTable();
+    void refreshView();
+
+    // Owned storage, used while building
+    std::vector<char16_t> text;
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> first;
+    std::vector<std::uint32_t> slots;
+    std::vector<Reading> readings;
+    AnswerTrie trie;
+    View view;
+};
+
+#endif // ANSWERMATCHER_H
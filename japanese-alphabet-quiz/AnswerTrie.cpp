@@ -0,0 +1,75 @@
+#include "AnswerTrie.h"
+#include "AnswerMatcher.h"
+
+void AnswerTrie::clear() {
+    nodes = {};
+    roots = {};
+    view = View();
+}
+
+std::uint32_t AnswerTrie::child(const Node *nodes, std::uint32_t count, std::uint32_t node, char16_t unit) {
+    for (std::uint32_t c = nodes[node].firstChild; c != 0 && c < count; c = nodes[c].nextSibling)
+        if (nodes[c].unit == unit) return c;
+    return 0;
+}
+
+void AnswerTrie::insert(std::uint32_t key, QStringView folded) {
+    if (nodes.empty()) nodes.emplace_back(); // index 0 stands for "none"
+    if (key >= roots.size()) roots.resize(key + 1, 0);
+    if (roots[key] == 0) {
+        roots[key] = std::uint32_t(nodes.size());
+        nodes.emplace_back();
+    }
+    std::uint32_t node = roots[key];
+    for (QChar c : folded) {
+        std::uint32_t next = child(nodes.data(), std::uint32_t(nodes.size()), node, c.unicode());
+        if (next == 0) {
+            next = std::uint32_t(nodes.size());
+            Node n;
+            n.unit = c.unicode();
+            n.nextSibling = nodes[node].firstChild;
+            nodes.push_back(n);
+            nodes[node].firstChild = next;
+        }
+        node = next;
+    }
+    nodes[node].terminal = true;
+    refreshView();
+}
+
+void AnswerTrie::squeeze() {
+    nodes.shrink_to_fit();
+    roots.shrink_to_fit();
+    refreshView();
+}
+
+void AnswerTrie::adopt(const View &mapped) {
+    clear();
+    view = mapped;
+}
+
+void AnswerTrie::refreshView() {
+    view.nodes = nodes.data();
+    view.nodeCount = std::uint32_t(nodes.size());
+    view.roots = roots.data();
+    view.rootCount = std::uint32_t(roots.size());
+}
+
+AnswerTrie::Progress AnswerTrie::progress(std::uint32_t key, QStringView input) const {
+    if (key >= view.rootCount || view.roots[key] == 0 || view.roots[key] >= view.nodeCount) return Progress::Mismatch;
+    // Spaces around the input are ignored, as matches() trims them, so the
+    // input is judged by the node reached before any trailing ones
+    QStringView typed = input.trimmed();
+    if (typed.isEmpty()) return Progress::Prefix; // nothing typed yet
+    std::uint32_t node = view.roots[key];
+    for (QChar c : typed) {
+        node = child(view.nodes, view.nodeCount, node, AnswerMatcher::fold(c.unicode()));
+        if (node == 0) return Progress::Mismatch;
+    }
+    if (!view.nodes[node].terminal) return Progress::Prefix;
+    return view.nodes[node].firstChild == 0 ? Progress::UniqueComplete : Progress::Complete;
+}
+
+std::size_t AnswerTrie::memoryUsage() const {
+    return nodes.capacity() * sizeof(Node) + roots.capacity() * sizeof(std::uint32_t);
+}
@@ -0,0 +1,57 @@
+#ifndef ANSWERTRIE_H
+#define ANSWERTRIE_H
+#include <QStringView>
+#include <cstdint>
+#include <vector>
+
+// Prefix trie over folded answers, one subtree per key (AnswerMatcher uses
+// 2 * word + kind). Live feedback walks it once per keystroke: O(input
+// length) steps over small sibling lists, no allocation.
+//
+// Like DeckStore, a trie is either built in memory or views arrays mapped
+// from a VocabularyCache.
+class AnswerTrie {
+public:
+    enum class Progress {
+        Mismatch,      // no answer starts with the input
+        Prefix,        // some answer continues the input
+        Complete,      // the input is an answer, and a longer one extends it
+        UniqueComplete // the input is an answer and nothing extends it
+    };
+    struct Node {
+        std::uint32_t firstChild = 0; // 0 = none; node 0 is never a child
+        std::uint32_t nextSibling = 0;
+        char16_t unit = 0;
+        bool terminal = false;
+    };
+    // The arrays a trie reads, laid out as the cache stores them
+    struct View {
+        const Node *nodes = nullptr;
+        std::uint32_t nodeCount = 0;
+        const std::uint32_t *roots = nullptr; // per key; 0 = no answers
+        std::uint32_t rootCount = 0;
+    };
+
+    void clear();
+    // `folded` must already be lower-cased (AnswerMatcher::fold).
+    void insert(std::uint32_t key, QStringView folded);
+    void squeeze();
+    // Serves arrays owned elsewhere; they must outlive the trie's use.
+    void adopt(const View &mapped);
+    const View &arrays() const { return view; }
+    // Surrounding spaces are ignored; the input is folded as it is walked.
+    Progress progress(std::uint32_t key, QStringView input) const;
+    std::size_t memoryUsage() const;
+
+private:
+    // Links read from a mapped file are bounds-checked; 0 if there is no such child.
+    static std::uint32_t child(const Node *nodes, std::uint32_t count, std::uint32_t node, char16_t unit);
+    void refreshView();
+
+    // Owned storage, used while building
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> roots;
+    View view;
+};
+
+#endif // ANSWERTRIE_H
@@ -0,0 +1,282 @@
+#include "AppController.h"
+#include "MainMenuDialog.h"
+#include "ProfileDialog.h"
+#include "QuizGame.h"
+#include "QuizWindow.h"
+#include "ReviewWindow.h"
+#include "SessionRandom.h"
+#include "VocabularyQuizWindow.h"
+#include "VocabularySelectionDialog.h"
+#include <QApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QPixmap>
+#include <QProgressDialog>
+#include <QSplashScreen>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Cards per "Review due" session; the rest wait for the next one
+constexpr std::size_t ReviewBatchSize = 100;
+}
+
+AppController::AppController(const QString &profilesDir, const QString &seedArgument, QObject *parent)
+    : QObject(parent), profilesDir(profilesDir), seedArgument(seedArgument), preloader(profilesDir) {
+}
+
+AppController::~AppController() {
+    delete splash;
+}
+
+void AppController::setState(State state) {
+    if (current == state) return;
+    current = state;
+    emit stateChanged(state);
+}
+
+void AppController::start() {
+    // Screens come and go between states; only finish() ends the app
+    qApp->setQuitOnLastWindowClosed(false);
+
+    QPixmap splashPixmap(":/appicon.png");
+    splash = new QSplashScreen(splashPixmap.scaled(400, 400, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    splash->show();
+
+    QDir().mkpath(profilesDir);
+#ifdef QUIZ_SQLITE_STORAGE
+    // Stats and scores live in SQLite; the JSON files are imported on first run
+    database = std::make_unique<SqliteStore>();
+    if (!database->open(SqliteStore::pathFor(profilesDir), "main") || !database->migrateFromJson(profilesDir)) {
+        qDebug() << "Falling back to JSON storage:" << database->errorString();
+        database.reset();
+    } else {
+        preloader.setDatabasePath(SqliteStore::pathFor(profilesDir));
+    }
+#endif
+    // Parse the vocabulary files in the background while the user picks a profile
+    preloader.start();
+    showProfileDialog();
+}
+
+void AppController::showProfileDialog() {
+    setState(State::Profile);
+    QStringList profiles;
+    for (const QString &file : QDir(profilesDir).entryList(QStringList() << "*.json", QDir::Files)) {
+        QString baseName = QFileInfo(file).baseName();
+        // Skip system files that are not user profiles
+        if (baseName != "vocabularies" && baseName != "vocabulary_scores") {
+            profiles << baseName;
+        }
+    }
+    auto *dialog = new ProfileDialog(profiles);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dialog, &QDialog::finished, this, [this, dialog](int result) {
+        profileName = dialog->selectedProfile();
+        splash->close();
+        if (result != QDialog::Accepted || profileName.isEmpty()) {
+            finish();
+            return;
+        }
+        profile = std::make_unique<ProfileStore>(profilesDir + "/" + profileName + ".json");
+        preloader.setProfile(profileName);
+#ifdef QUIZ_SQLITE_STORAGE
+        profile->setDatabase(database.get());
+#endif
+        srs.load(SrsScheduler::pathForProfile(profile->filePath()));
+        seedSession();
+        showMenu();
+    });
+    dialog->open();
+}
+
+// Seed the session's random engine once: --seed wins, then the profile's
+// "rng_seed" setting, otherwise a random seed. The setting is a decimal
+// string, since a JSON number is a double and loses seeds above 2^53.
+void AppController::seedSession() {
+    bool seedOk = false;
+    quint64 seed = seedArgument.toULongLong(&seedOk);
+    if (!seedOk && profile->contains("rng_seed")) {
+        QJsonValue stored = profile->value("rng_seed");
+        if (stored.isString()) {
+            seed = stored.toString().toULongLong(&seedOk);
+        } else if (stored.isDouble()) {
+            // Older profiles wrote a number; only seeds a double holds exactly
+            double number = stored.toDouble();
+            seedOk = number >= 0 && number <= 9007199254740992.0 && number == std::floor(number);
+            seed = seedOk ? quint64(number) : 0;
+        }
+        if (!seedOk) qDebug() << "Ignoring rng_seed that is not a decimal seed:" << stored;
+    }
+    if (seedOk) {
+        SessionRandom::seedFixed(seed);
+    } else {
+        SessionRandom::seedRandom();
+    }
+    qDebug() << "Session seed:" << SessionRandom::seed() << (SessionRandom::isFixed() ? "(fixed)" : "");
+}
+
+void AppController::showMenu() {
+    setState(State::Menu);
+    // Every screen returns here, so this is where its reviews are written
+    saveSchedule();
+    auto *menu = new MainMenuDialog(profileName, int(srs.dueCount(QDateTime::currentSecsSinceEpoch())));
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+    connect(menu, &QDialog::finished, this, [this, menu](int result) {
+        if (result != QDialog::Accepted) {
+            finish(); // User chose exit or closed dialog
+            return;
+        }
+        switch (menu->getChoice()) {
+        case MainMenuDialog::AlphabetQuiz: startAlphabetQuiz(); break;
+        case MainMenuDialog::Vocabularies: openVocabularies(); break;
+        case MainMenuDialog::ReviewDue: startReview(); break;
+        case MainMenuDialog::Exit: finish(); break;
+        }
+    });
+    menu->open();
+}
+
+void AppController::startAlphabetQuiz() {
+    setState(State::AlphabetQuiz);
+    auto *window = new QuizWindow(profile.get());
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    auto *game = new QuizGame(window); // owned by the window
+    game->setScheduler(&srs);
+    // After the game is connected, so the loaded settings rebuild its round once
+    window->loadPreferences();
+    // After quiz window closes, return to main menu
+    connect(window, &QObject::destroyed, this, &AppController::showMenu);
+    window->show();
+}
+
+void AppController::startReview() {
+    std::vector<QString> keys = srs.due(QDateTime::currentSecsSinceEpoch(), ReviewBatchSize);
+    const bool hasWords =
+        std::any_of(keys.begin(), keys.end(), [](const QString &key) { return SrsScheduler::isWordKey(key); });
+    auto open = [this, keys, hasWords]() {
+        setState(State::Review);
+        if (hasWords && !reviewDecks) {
+            if (!deckStore) deckStore = preloader.decks();
+            reviewDecks = std::make_unique<ReviewDecks>(deckStore, preloader.decksComplete());
+        }
+        auto *window = new ReviewWindow(srs, hasWords ? reviewDecks.get() : nullptr, keys);
+        window->setAttribute(Qt::WA_DeleteOnClose);
+        connect(window, &QObject::destroyed, this, &AppController::showMenu);
+        window->show();
+    };
+    // Word cards need the decks to show and check them
+    if (hasWords)
+        whenDecksReady(open);
+    else
+        open();
+}
+
+void AppController::openVocabularies() {
+    whenDecksReady([this]() { showVocabularySelection(); });
+}
+
+void AppController::whenDecksReady(std::function<void()> next) {
+    // Vocabularies were loading since startup; wait for the rest if needed
+    if (preloader.decksReady()) {
+        next();
+        return;
+    }
+    setState(State::LoadingVocabularies);
+    // Large decks take a while; cancelling keeps what was read so far
+    auto *loading = new QProgressDialog("Loading vocabularies...", "Use loaded", 0, 1000);
+    loading->setWindowModality(Qt::ApplicationModal);
+    loading->setMinimumDuration(500);
+    connect(&preloader, &StartupPreloader::deckProgress, loading,
+        [loading](qint64 bytesRead, qint64 totalBytes, int decksLoaded) {
+            loading->setLabelText(QString("Loading vocabularies... %1 loaded").arg(decksLoaded));
+            if (totalBytes > 0) loading->setValue(static_cast<int>(bytesRead * 1000 / totalBytes));
+        });
+    connect(loading, &QProgressDialog::canceled, &preloader, &StartupPreloader::cancelDeckLoad);
+    connect(&preloader, &StartupPreloader::decksLoaded, loading, [loading, next]() {
+        loading->deleteLater();
+        next();
+    });
+}
+
+void AppController::showVocabularySelection() {
+    if (!deckStore) deckStore = preloader.decks();
+    if (deckStore->isEmpty()) {
+        // Nothing to practice; back to the menu
+        showMenu();
+        return;
+    }
+    setState(State::VocabularySelection);
+    // This profile's scores, read in the background as well
+    profileScores = preloader.scores();
+
+    // User preferences (message duration) from the profile
+    int initialMessageDurationSeconds = 2; // fallback default
+    int savedDuration = profile->intValue("messageDurationSeconds", 2);
+    if (savedDuration >= 1 && savedDuration <= 10) { // validate range
+        initialMessageDurationSeconds = savedDuration;
+    }
+
+    // Show vocabulary selection dialog (comment preference now handled only inside quiz window)
+    auto *dialog = new VocabularySelectionDialog(*deckStore, profileScores, profile.get(), initialMessageDurationSeconds);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dialog, &QDialog::finished, this, [this, dialog](int result) {
+        if (result == QDialog::Accepted) {
+            startVocabularyQuiz(dialog);
+        } else {
+            showMenu();
+        }
+    });
+    dialog->open();
+}
+
+void AppController::startVocabularyQuiz(VocabularySelectionDialog *dialog) {
+    const DeckStore &decks = *deckStore;
+    int messageDuration = dialog->getMessageDuration();
+    // Persist updated message duration preference
+    profile->setValue("messageDurationSeconds", messageDuration);
+
+    // Get selected vocabulary words and the name scores are tracked under
+    std::vector<WordId> wordsToQuiz;
+    QString vocabName = "All Vocabularies";
+    if (dialog->isPracticeAll()) {
+        wordsToQuiz = decks.allWords();
+    } else if (dialog->isPracticeSelected()) {
+        wordsToQuiz = dialog->getSelectedWords();
+        vocabName = "Selected Words";
+    } else {
+        int selectedIndex = dialog->getSelectedVocabularyIndex();
+        if (selectedIndex >= 0 && selectedIndex < decks.deckCount()) {
+            wordsToQuiz = decks.deckWords(selectedIndex);
+            vocabName = decks.deckName(selectedIndex).toString();
+        }
+    }
+    if (wordsToQuiz.empty()) {
+        showMenu();
+        return;
+    }
+
+    setState(State::VocabularyQuiz);
+    auto *vocabQuiz = new VocabularyQuizWindow(
+        decks, wordsToQuiz, profile.get(), profileName, vocabName, preloader.scoresFile(), messageDuration);
+    vocabQuiz->setAttribute(Qt::WA_DeleteOnClose);
+    vocabQuiz->setScheduler(&srs);
+    connect(vocabQuiz, &QObject::destroyed, this, [this]() {
+        // The quiz may have saved new best scores
+        preloader.reloadScores();
+        showMenu();
+    });
+    vocabQuiz->show();
+}
+
+void AppController::saveSchedule() {
+    if (profile && srs.isDirty()) srs.save(SrsScheduler::pathForProfile(profile->filePath()));
+}
+
+void AppController::finish() {
+    saveSchedule();
+    setState(State::Finished);
+    qApp->quit();
+}
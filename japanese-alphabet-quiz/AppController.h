@@ -0,0 +1,69 @@
+#ifndef APPCONTROLLER_H
+#define APPCONTROLLER_H
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <memory>
+#include "ProfileStore.h"
+#include "ReviewSession.h"
+#include "SrsScheduler.h"
+#include "StartupPreloader.h"
+#ifdef QUIZ_SQLITE_STORAGE
+#include "SqliteStore.h"
+#endif
+
+class QSplashScreen;
+class VocabularySelectionDialog;
+
+// Drives the application from the single QApplication event loop:
+// profile -> menu -> alphabet or vocabulary quiz -> menu ... Every screen is
+// opened non-blocking and the next state is entered from its finished or
+// destroyed signal, so the process sleeps while the user is idle.
+class AppController : public QObject {
+    Q_OBJECT
+public:
+    enum class State { Idle, Profile, Menu, AlphabetQuiz, LoadingVocabularies, VocabularySelection, VocabularyQuiz, Review, Finished };
+    Q_ENUM(State)
+
+    // `seedArgument` is the --seed value, empty if not given.
+    AppController(const QString &profilesDir, const QString &seedArgument, QObject *parent = nullptr);
+    ~AppController() override;
+
+    void start();
+    State state() const { return current; }
+
+signals:
+    void stateChanged(AppController::State state);
+
+private:
+    void setState(State state);
+    void showProfileDialog();
+    void seedSession();
+    void showMenu();
+    void startAlphabetQuiz();
+    void startReview();
+    // Runs `next` once the vocabularies have loaded, with a progress dialog meanwhile.
+    void whenDecksReady(std::function<void()> next);
+    void openVocabularies();
+    void showVocabularySelection();
+    void startVocabularyQuiz(VocabularySelectionDialog *dialog);
+    void saveSchedule();
+    void finish();
+
+    QString profilesDir;
+    QString seedArgument;
+    QString profileName;
+#ifdef QUIZ_SQLITE_STORAGE
+    std::unique_ptr<SqliteStore> database; // null if it could not be opened
+#endif
+    std::unique_ptr<ProfileStore> profile;
+    State current = State::Idle;
+    StartupPreloader preloader;
+    QSplashScreen *splash = nullptr;
+    std::shared_ptr<const DeckStore> deckStore;
+    ProfileScores profileScores;
+    SrsScheduler srs; // the profile's review schedule
+    std::unique_ptr<ReviewDecks> reviewDecks; // indexed on the first review of a word
+};
+
+#endif // APPCONTROLLER_H
@@ -0,0 +1,239 @@
+#include "DeckStore.h"
+#include "VocabularyCache.h"
+#include <QHash>
+#include <algorithm>
+
+namespace {
+const QString &wordField(const VocabularyWord &w, int f) {
+    switch (f) {
+    case DeckStore::Romaji: return w.romaji;
+    case DeckStore::English: return w.english;
+    case DeckStore::Hiragana: return w.hiragana;
+    case DeckStore::Katakana: return w.katakana;
+    case DeckStore::Kanji: return w.kanji;
+    case DeckStore::Comment: return w.comment;
+    default: return w.hint;
+    }
+}
+}
+
+QStringView DeckStore::WordView::displayText() const {
+    QStringView text = hiragana();
+    if (text.isEmpty()) text = katakana();
+    if (text.isEmpty()) text = kanji();
+    return text;
+}
+
+VocabularyWord DeckStore::WordView::toWord() const {
+    VocabularyWord w;
+    w.romaji = romaji().toString();
+    w.english = english().toString();
+    w.hiragana = hiragana().toString();
+    w.katakana = katakana().toString();
+    w.kanji = kanji().toString();
+    w.comment = comment().toString();
+    w.hint = hint().toString();
+    return w;
+}
+
+DeckStore::DeckStore() {
+    refreshView();
+}
+
+DeckStore::DeckStore(DeckStore &&other) noexcept {
+    *this = std::move(other);
+}
+
+DeckStore &DeckStore::operator=(DeckStore &&other) noexcept {
+    if (this == &other) return *this;
+    // Moving the vectors keeps their buffers, so only the view needs redoing
+    arena = std::move(other.arena);
+    columns = std::move(other.columns);
+    deckIndex = std::move(other.deckIndex);
+    interned = std::move(other.interned);
+    internSlots = std::move(other.internSlots);
+    mapping = std::move(other.mapping);
+    matcher = std::move(other.matcher);
+    refreshView();
+    other.clear();
+    return *this;
+}
+
+DeckStore::~DeckStore() = default;
+
+DeckStore DeckStore::fromVocabularies(const std::vector<Vocabulary> &vocabularies) {
+    DeckStore store;
+    for (const Vocabulary &vocab : vocabularies)
+        store.addDeck(vocab);
+    store.squeeze();
+    return store;
+}
+
+void DeckStore::clear() {
+    arena.clear();
+    for (auto &col : columns) col.clear();
+    deckIndex.clear();
+    interned.clear();
+    internSlots.clear();
+    mapping.reset();
+    matcher.clear();
+    refreshView();
+}
+
+void DeckStore::addDeck(const Vocabulary &vocab) {
+    if (mapping) {
+        // Copy the mapped decks out before appending to them
+        std::vector<Vocabulary> existing = toVocabularies();
+        clear();
+        for (const Vocabulary &v : existing) addDeck(v);
+    }
+    DeckRecord deck;
+    deck.name = intern(vocab.name);
+    deck.firstWord = static_cast<std::uint32_t>(columns[0].size());
+    deck.wordCount = static_cast<std::uint32_t>(vocab.words.size());
+    deckIndex.push_back(deck);
+    for (const VocabularyWord &w : vocab.words) {
+        for (int f = 0; f < FieldCount; ++f)
+            columns[f].push_back(intern(wordField(w, f)));
+    }
+    refreshView();
+}
+
+void DeckStore::squeeze() {
+    interned = {};
+    internSlots = {};
+    arena.shrink_to_fit();
+    for (auto &col : columns) col.shrink_to_fit();
+    deckIndex.shrink_to_fit();
+    refreshView();
+    matcher.build(*this);
+}
+
+void DeckStore::adopt(std::shared_ptr<const VocabularyCache> cache) {
+    clear();
+    if (!cache || !cache->isOpen()) return;
+    mapping = std::move(cache);
+    refreshView();
+    // The answer index was compiled with the cache; serve it mapped too
+    matcher.adopt(mapping->answers());
+}
+
+void DeckStore::refreshView() {
+    view = View();
+    if (mapping) {
+        view.text = mapping->text();
+        view.textUnits = mapping->textUnits();
+        for (int f = 0; f < FieldCount; ++f)
+            view.columns[f] = mapping->column(static_cast<Field>(f));
+        view.decks = mapping->decks();
+        view.deckCount = static_cast<std::uint32_t>(mapping->deckCount());
+        view.wordCount = static_cast<std::uint32_t>(mapping->wordCount());
+        return;
+    }
+    view.text = arena.data();
+    view.textUnits = static_cast<std::uint32_t>(arena.size());
+    for (int f = 0; f < FieldCount; ++f)
+        view.columns[f] = columns[f].data();
+    view.decks = deckIndex.data();
+    view.deckCount = static_cast<std::uint32_t>(deckIndex.size());
+    view.wordCount = static_cast<std::uint32_t>(columns[0].size());
+}
+
+// --- Interning ---
+
+DeckStore::StringRef DeckStore::intern(QStringView s) {
+    if (s.isEmpty()) return {};
+    if ((interned.size() + 1) * 2 > internSlots.size()) growInternTable();
+    const std::size_t mask = internSlots.size() - 1;
+    for (std::size_t i = qHash(s) & mask;; i = (i + 1) & mask) {
+        std::uint32_t slot = internSlots[i];
+        if (slot == 0) {
+            StringRef ref{static_cast<std::uint32_t>(arena.size()), static_cast<std::uint32_t>(s.size())};
+            arena.insert(arena.end(), s.utf16(), s.utf16() + s.size());
+            interned.push_back(ref);
+            internSlots[i] = static_cast<std::uint32_t>(interned.size());
+            return ref;
+        }
+        StringRef ref = interned[slot - 1];
+        if (ref.length == std::uint32_t(s.size()) && QStringView(arena.data() + ref.offset, s.size()) == s)
+            return ref;
+    }
+}
+
+void DeckStore::growInternTable() {
+    std::vector<std::uint32_t> slots(std::max<std::size_t>(64, internSlots.size() * 2), 0);
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t n = 0; n < interned.size(); ++n) {
+        QStringView s(arena.data() + interned[n].offset, qsizetype(interned[n].length));
+        std::size_t i = qHash(s) & mask;
+        while (slots[i] != 0) i = (i + 1) & mask;
+        slots[i] = static_cast<std::uint32_t>(n + 1);
+    }
+    internSlots = std::move(slots);
+}
+
+// --- Reading ---
+
+QStringView DeckStore::deckName(int deck) const {
+    if (deck < 0 || std::uint32_t(deck) >= view.deckCount) return {};
+    StringRef ref = view.decks[deck].name;
+    if (std::uint64_t(ref.offset) + ref.length > view.textUnits) return {};
+    return QStringView(view.text + ref.offset, qsizetype(ref.length));
+}
+
+WordId DeckStore::deckFirstWord(int deck) const {
+    if (deck < 0 || std::uint32_t(deck) >= view.deckCount) return 0;
+    return view.decks[deck].firstWord;
+}
+
+int DeckStore::deckWordCount(int deck) const {
+    if (deck < 0 || std::uint32_t(deck) >= view.deckCount) return 0;
+    const DeckRecord &d = view.decks[deck];
+    if (std::uint64_t(d.firstWord) + d.wordCount > view.wordCount) return 0;
+    return static_cast<int>(d.wordCount);
+}
+
+std::vector<WordId> DeckStore::deckWords(int deck) const {
+    std::vector<WordId> ids(std::size_t(deckWordCount(deck)));
+    WordId first = deckFirstWord(deck);
+    for (std::size_t i = 0; i < ids.size(); ++i) ids[i] = first + WordId(i);
+    return ids;
+}
+
+std::vector<WordId> DeckStore::allWords() const {
+    std::vector<WordId> ids(view.wordCount);
+    for (std::size_t i = 0; i < ids.size(); ++i) ids[i] = WordId(i);
+    return ids;
+}
+
+QStringView DeckStore::field(WordId word, Field f) const {
+    if (word >= view.wordCount) return {};
+    StringRef ref = view.columns[f][word];
+    if (std::uint64_t(ref.offset) + ref.length > view.textUnits) return {};
+    return QStringView(view.text + ref.offset, qsizetype(ref.length));
+}
+
+std::vector<Vocabulary> DeckStore::toVocabularies() const {
+    std::vector<Vocabulary> result;
+    result.reserve(view.deckCount);
+    for (int d = 0; d < deckCount(); ++d) {
+        Vocabulary vocab;
+        vocab.name = deckName(d).toString();
+        WordId first = deckFirstWord(d);
+        int count = deckWordCount(d);
+        vocab.words.reserve(std::size_t(count));
+        for (WordId id = first; id < first + WordId(count); ++id)
+            vocab.words.push_back(word(id).toWord());
+        result.push_back(std::move(vocab));
+    }
+    return result;
+}
+
+std::size_t DeckStore::memoryUsage() const {
+    std::size_t bytes = matcher.memoryUsage();
+    if (mapping) return bytes; // other pages belong to the mapping
+    bytes += arena.capacity() * sizeof(char16_t) + deckIndex.capacity() * sizeof(DeckRecord);
+    for (const auto &col : columns) bytes += col.capacity() * sizeof(StringRef);
+    bytes += interned.capacity() * sizeof(StringRef) + internSlots.capacity() * sizeof(std::uint32_t);
+    return bytes;
+}
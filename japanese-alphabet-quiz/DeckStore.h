@@ -0,0 +1,126 @@
+#ifndef DECKSTORE_H
+#define DECKSTORE_H
+#include <QString>
+#include <QStringView>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "AnswerMatcher.h"
+#include "VocabularyData.h"
+
+class VocabularyCache;
+
+using WordId = std::uint32_t;
+
+// Every loaded vocabulary word, stored column-wise. All text lives once in a
+// single UTF-16 arena (identical strings, e.g. a hiragana field that repeats
+// the legacy "japanese" one, share one copy) and each field is a column of
+// offset/length pairs indexed by WordId. Decks are contiguous WordId ranges.
+//
+// A store is either built in memory while loading or views the arrays of a
+// mapped VocabularyCache in place.
+class DeckStore {
+public:
+    enum Field { Romaji, English, Hiragana, Katakana, Kanji, Comment, Hint, FieldCount };
+    struct StringRef {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+    struct DeckRecord {
+        StringRef name;
+        std::uint32_t firstWord = 0;
+        std::uint32_t wordCount = 0;
+    };
+
+    // Handle to one word; valid while its store is alive and unchanged.
+    class WordView {
+    public:
+        WordView() = default;
+        WordView(const DeckStore *store, WordId id) : store(store), wordId(id) {}
+        bool isValid() const { return store != nullptr; }
+        WordId id() const { return wordId; }
+        QStringView field(Field f) const { return store->field(wordId, f); }
+        QStringView romaji() const { return field(Romaji); }
+        QStringView english() const { return field(English); }
+        QStringView hiragana() const { return field(Hiragana); }
+        QStringView katakana() const { return field(Katakana); }
+        QStringView kanji() const { return field(Kanji); }
+        QStringView comment() const { return field(Comment); }
+        QStringView hint() const { return field(Hint); }
+        // Hiragana, else katakana, else kanji: the text a question shows.
+        QStringView displayText() const;
+        VocabularyWord toWord() const;
+
+    private:
+        const DeckStore *store = nullptr;
+        WordId wordId = 0;
+    };
+
+    DeckStore();
+    DeckStore(DeckStore &&other) noexcept;
+    DeckStore &operator=(DeckStore &&other) noexcept;
+    DeckStore(const DeckStore &) = delete;
+    DeckStore &operator=(const DeckStore &) = delete;
+    ~DeckStore();
+
+    static DeckStore fromVocabularies(const std::vector<Vocabulary> &vocabularies);
+    // Appends a deck; its words get the next WordIds.
+    void addDeck(const Vocabulary &vocab);
+    // Drops the intern table and spare capacity once loading is done, and
+    // builds the answer index.
+    void squeeze();
+    // Serves the cache's arrays without copying; the store keeps it mapped.
+    void adopt(std::shared_ptr<const VocabularyCache> cache);
+    void clear();
+
+    int deckCount() const { return static_cast<int>(view.deckCount); }
+    int wordCount() const { return static_cast<int>(view.wordCount); }
+    bool isEmpty() const { return view.deckCount == 0; }
+    QStringView deckName(int deck) const;
+    WordId deckFirstWord(int deck) const;
+    int deckWordCount(int deck) const;
+    std::vector<WordId> deckWords(int deck) const;
+    std::vector<WordId> allWords() const;
+
+    QStringView field(WordId word, Field f) const;
+    WordView word(WordId id) const { return WordView(this, id); }
+    std::vector<Vocabulary> toVocabularies() const;
+    // Normalized accepted answers; current as of the last squeeze() or adopt().
+    const AnswerMatcher &answers() const { return matcher; }
+
+    // Raw arrays, laid out as the cache stores them
+    const char16_t *text() const { return view.text; }
+    std::uint32_t textUnits() const { return view.textUnits; }
+    const StringRef *column(Field f) const { return view.columns[f]; }
+    const DeckRecord *decks() const { return view.decks; }
+    // Bytes held by the arena, columns, deck index and answer index.
+    std::size_t memoryUsage() const;
+
+private:
+    struct View {
+        const char16_t *text = nullptr;
+        std::uint32_t textUnits = 0;
+        std::array<const StringRef *, FieldCount> columns{};
+        const DeckRecord *decks = nullptr;
+        std::uint32_t deckCount = 0;
+        std::uint32_t wordCount = 0;
+    };
+    StringRef intern(QStringView s);
+    void growInternTable();
+    void refreshView();
+
+    // Owned storage, used while building
+    std::vector<char16_t> arena;
+    std::array<std::vector<StringRef>, FieldCount> columns;
+    std::vector<DeckRecord> deckIndex;
+    // Open-addressed set of distinct arena strings; slot = index + 1, 0 = empty
+    std::vector<StringRef> interned;
+    std::vector<std::uint32_t> internSlots;
+    // Mapped storage
+    std::shared_ptr<const VocabularyCache> mapping;
+    View view;
+    AnswerMatcher matcher;
+};
+
+#endif // DECKSTORE_H
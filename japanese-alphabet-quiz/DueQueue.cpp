@@ -0,0 +1,103 @@
+#include "DueQueue.h"
+#include <queue>
+
+void DueQueue::clear() {
+    heap.clear();
+    slot.clear();
+}
+
+void DueQueue::schedule(std::uint32_t item, std::int64_t due) {
+    if (item >= slot.size()) slot.resize(std::size_t(item) + 1, NoItem);
+    if (slot[item] == NoItem) {
+        heap.push_back({due, item});
+        slot[item] = std::uint32_t(heap.size() - 1);
+        siftUp(heap.size() - 1);
+        return;
+    }
+    const std::size_t pos = slot[item];
+    const std::int64_t old = heap[pos].due;
+    heap[pos].due = due;
+    if (due < old) siftUp(pos);
+    else siftDown(pos);
+}
+
+void DueQueue::remove(std::uint32_t item) {
+    if (!contains(item)) return;
+    const std::size_t pos = slot[item];
+    slot[item] = NoItem;
+    const Entry last = heap.back();
+    heap.pop_back();
+    if (pos == heap.size()) return;
+    // The last entry fills the hole and moves whichever way it belongs
+    place(pos, last);
+    siftUp(pos);
+    siftDown(slot[last.item]);
+}
+
+std::uint32_t DueQueue::pop() {
+    const std::uint32_t item = top();
+    remove(item);
+    return item;
+}
+
+// Best-first walk from the root: a child can only be due if its parent is.
+std::vector<std::uint32_t> DueQueue::dueBy(std::int64_t now, std::size_t limit) const {
+    std::vector<std::uint32_t> items;
+    auto later = [this](std::size_t a, std::size_t b) { return heap[a].due > heap[b].due; };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> frontier(later);
+    if (!heap.empty()) frontier.push(0);
+    while (!frontier.empty() && items.size() < limit) {
+        const std::size_t pos = frontier.top();
+        frontier.pop();
+        if (heap[pos].due > now) break;
+        items.push_back(heap[pos].item);
+        for (std::size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap.size(); ++child)
+            frontier.push(child);
+    }
+    return items;
+}
+
+std::size_t DueQueue::countDueBy(std::int64_t now) const {
+    std::size_t count = 0;
+    std::vector<std::size_t> stack;
+    if (!heap.empty()) stack.push_back(0);
+    while (!stack.empty()) {
+        const std::size_t pos = stack.back();
+        stack.pop_back();
+        if (heap[pos].due > now) continue;
+        ++count;
+        for (std::size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap.size(); ++child)
+            stack.push_back(child);
+    }
+    return count;
+}
+
+void DueQueue::place(std::size_t pos, const Entry &entry) {
+    heap[pos] = entry;
+    slot[entry.item] = std::uint32_t(pos);
+}
+
+void DueQueue::siftUp(std::size_t pos) {
+    const Entry entry = heap[pos];
+    while (pos > 0) {
+        const std::size_t parent = (pos - 1) / 2;
+        if (heap[parent].due <= entry.due) break;
+        place(pos, heap[parent]);
+        pos = parent;
+    }
+    place(pos, entry);
+}
+
+void DueQueue::siftDown(std::size_t pos) {
+    const Entry entry = heap[pos];
+    const std::size_t n = heap.size();
+    while (true) {
+        std::size_t child = 2 * pos + 1;
+        if (child >= n) break;
+        if (child + 1 < n && heap[child + 1].due < heap[child].due) ++child;
+        if (heap[child].due >= entry.due) break;
+        place(pos, heap[child]);
+        pos = child;
+    }
+    place(pos, entry);
+}
@@ -0,0 +1,45 @@
+#ifndef DUEQUEUE_H
+#define DUEQUEUE_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Indexed binary min-heap of items by due time. Each item remembers its
+// heap slot, so rescheduling one is an O(log n) sift rather than a rebuild,
+// and the earliest item is always at the top. Listing the k items due by
+// some time visits only those k and their children: O(k log k), however
+// many items are scheduled further out.
+class DueQueue {
+public:
+    static constexpr std::uint32_t NoItem = 0xFFFFFFFFu;
+
+    void clear();
+    // Inserts the item, or moves it if it is already queued.
+    void schedule(std::uint32_t item, std::int64_t due);
+    void remove(std::uint32_t item);
+    bool contains(std::uint32_t item) const { return item < slot.size() && slot[item] != NoItem; }
+    std::size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+    // The earliest item, or NoItem if the queue is empty.
+    std::uint32_t top() const { return heap.empty() ? NoItem : heap.front().item; }
+    std::int64_t topDue() const { return heap.front().due; }
+    std::uint32_t pop();
+    // Up to `limit` items due at or before `now`, earliest first; the queue is unchanged.
+    std::vector<std::uint32_t> dueBy(std::int64_t now, std::size_t limit) const;
+    // How many items are due at or before `now`.
+    std::size_t countDueBy(std::int64_t now) const;
+
+private:
+    struct Entry {
+        std::int64_t due;
+        std::uint32_t item;
+    };
+    void place(std::size_t pos, const Entry &entry);
+    void siftUp(std::size_t pos);
+    void siftDown(std::size_t pos);
+
+    std::vector<Entry> heap;
+    std::vector<std::uint32_t> slot; // item -> heap position, NoItem if not queued
+};
+
+#endif // DUEQUEUE_H
@@ -0,0 +1,150 @@
+#include "EditDistance.h"
+#include "AnswerMatcher.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+inline char16_t fold(QChar c) {
+    return AnswerMatcher::fold(c.unicode());
+}
+
+// Match masks of a pattern of at most 64 units: bit i of peq(c) is set
+// where pattern[i] == c. ASCII is a direct table; other units (rare in
+// romaji and English) a short linear list.
+class PatternMasks {
+public:
+    explicit PatternMasks(QStringView pattern) {
+        for (qsizetype i = 0; i < pattern.size(); ++i) {
+            char16_t c = fold(pattern[i]);
+            std::uint64_t bit = std::uint64_t(1) << i;
+            if (c < 0x80) {
+                ascii[c] |= bit;
+                continue;
+            }
+            int k = 0;
+            while (k < otherCount && otherUnits[k] != c) ++k;
+            if (k == otherCount) {
+                otherUnits[k] = c;
+                otherMasks[k] = 0;
+                ++otherCount;
+            }
+            otherMasks[k] |= bit;
+        }
+    }
+    std::uint64_t operator()(char16_t c) const {
+        if (c < 0x80) return ascii[c];
+        for (int k = 0; k < otherCount; ++k)
+            if (otherUnits[k] == c) return otherMasks[k];
+        return 0;
+    }
+
+private:
+    std::array<std::uint64_t, 128> ascii{};
+    std::array<char16_t, 64> otherUnits{};
+    std::array<std::uint64_t, 64> otherMasks{};
+    int otherCount = 0;
+};
+
+// Myers (1999) in Hyyrö's formulation for global distance: the vertical
+// deltas of one DP column are kept as bit vectors Pv/Mv and each text unit
+// advances the whole column in a handful of word operations.
+int myers(QStringView pattern, QStringView text) {
+    const int m = int(pattern.size());
+    if (m == 0) return int(text.size());
+    PatternMasks peq(pattern);
+    const std::uint64_t last = std::uint64_t(1) << (m - 1);
+    std::uint64_t pv = ~std::uint64_t(0), mv = 0;
+    int score = m;
+    for (QChar c : text) {
+        std::uint64_t eq = peq(fold(c));
+        std::uint64_t xv = eq | mv;
+        std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        if (ph & last) ++score;
+        else if (mh & last) --score;
+        // Row 0 grows by one per text unit, hence the 1 shifted into ph
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+// Ukkonen's band: only cells within maxEdits of the diagonal can end at or
+// below maxEdits.
+int banded(QStringView a, QStringView b, int maxEdits) {
+    const int n = int(a.size()), m = int(b.size());
+    const int over = maxEdits + 1;
+    std::vector<int> prev(m + 1, over), cur(m + 1, over);
+    for (int j = 0; j <= std::min(m, maxEdits); ++j) prev[j] = j;
+    for (int i = 1; i <= n; ++i) {
+        const int lo = std::max(1, i - maxEdits), hi = std::min(m, i + maxEdits);
+        // The next row reads only the band and one cell either side of it,
+        // so those are all that is reset; the row costs O(maxEdits)
+        cur[lo - 1] = lo == 1 && i <= maxEdits ? i : over;
+        if (hi < m) cur[hi + 1] = over;
+        int rowMin = cur[lo - 1];
+        char16_t ca = fold(a[i - 1]);
+        for (int j = lo; j <= hi; ++j) {
+            int sub = prev[j - 1] + (ca == fold(b[j - 1]) ? 0 : 1);
+            int v = std::min({sub, prev[j] + 1, cur[j - 1] + 1});
+            cur[j] = std::min(v, over);
+            rowMin = std::min(rowMin, cur[j]);
+        }
+        if (rowMin >= over) return over;
+        std::swap(prev, cur);
+    }
+    return std::min(prev[m], over);
+}
+}
+
+int EditDistance::bounded(QStringView a, QStringView b, int maxEdits) {
+    if (maxEdits < 0) return 0;
+    if (std::abs(int(a.size()) - int(b.size())) > maxEdits) return maxEdits + 1;
+    // The shorter string is the pattern, so most answers fit one word
+    if (a.size() > b.size()) std::swap(a, b);
+    int d = a.size() <= 64 ? myers(a, b) : banded(a, b, maxEdits);
+    return std::min(d, maxEdits + 1);
+}
+
+std::vector<EditDistance::Step> EditDistance::diff(QStringView expected, QStringView typed) {
+    const qsizetype n = expected.size(), m = typed.size();
+    const qsizetype w = m + 1;
+    std::vector<int> d((n + 1) * w);
+    for (qsizetype i = 0; i <= n; ++i) d[i * w] = int(i);
+    for (qsizetype j = 0; j <= m; ++j) d[j] = int(j);
+    for (qsizetype i = 1; i <= n; ++i) {
+        for (qsizetype j = 1; j <= m; ++j) {
+            int sub = d[(i - 1) * w + j - 1] + (fold(expected[i - 1]) == fold(typed[j - 1]) ? 0 : 1);
+            d[i * w + j] = std::min({sub, d[(i - 1) * w + j] + 1, d[i * w + j - 1] + 1});
+        }
+    }
+    // Walk back from the end, preferring the diagonal so substitutions
+    // line up under the character they replace
+    std::vector<Step> steps;
+    qsizetype i = n, j = m;
+    while (i > 0 || j > 0) {
+        if (i > 0 && j > 0) {
+            bool same = fold(expected[i - 1]) == fold(typed[j - 1]);
+            if (d[i * w + j] == d[(i - 1) * w + j - 1] + (same ? 0 : 1)) {
+                steps.push_back({same ? Op::Equal : Op::Substitute, i - 1, j - 1});
+                --i;
+                --j;
+                continue;
+            }
+        }
+        if (i > 0 && d[i * w + j] == d[(i - 1) * w + j] + 1) {
+            steps.push_back({Op::Missing, i - 1, -1});
+            --i;
+        } else {
+            steps.push_back({Op::Extra, -1, j - 1});
+            --j;
+        }
+    }
+    std::reverse(steps.begin(), steps.end());
+    return steps;
+}
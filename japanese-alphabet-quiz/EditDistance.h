@@ -0,0 +1,28 @@
+#ifndef EDITDISTANCE_H
+#define EDITDISTANCE_H
+#include <QStringView>
+#include <vector>
+
+// Case-insensitive Levenshtein distance for answer checking. bounded()
+// uses Myers' bit-parallel algorithm (one 64-bit word per column, so
+// strings of up to 64 units take O(n) word operations). Longer pairs fall
+// back to a DP band of width 2 * maxEdits + 1. Neither allocates for
+// strings of 64 units or fewer.
+class EditDistance {
+public:
+    enum class Op : unsigned char { Equal, Substitute, Missing, Extra };
+    struct Step {
+        Op op;
+        qsizetype expectedIndex; // -1 for Extra
+        qsizetype typedIndex;    // -1 for Missing
+    };
+
+    // The distance between `a` and `b`, or maxEdits + 1 if it is larger.
+    static int bounded(QStringView a, QStringView b, int maxEdits);
+    // A minimal alignment of `typed` against `expected`, for highlighting:
+    // which expected characters were typed wrong or left out, and which
+    // typed characters are extra. O(n * m); meant for the feedback path.
+    static std::vector<Step> diff(QStringView expected, QStringView typed);
+};
+
+#endif // EDITDISTANCE_H
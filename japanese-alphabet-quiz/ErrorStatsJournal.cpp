@@ -0,0 +1,104 @@
+#include "ErrorStatsJournal.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+constexpr char Magic[4] = {'J', 'Q', 'E', 'J'};
+constexpr qint64 HeaderSize = 12;
+constexpr qint64 RecordSize = 8;
+}
+
+ErrorStatsJournal::ErrorStatsJournal(const QString &path) {
+    setPath(path);
+}
+
+void ErrorStatsJournal::setPath(const QString &path) {
+    if (file.isOpen()) file.close();
+    file.setFileName(path);
+}
+
+QString ErrorStatsJournal::pathForProfile(const QString &profileJsonPath) {
+    QString base = profileJsonPath;
+    if (base.endsWith(".json")) base.chop(5);
+    return base + ".errors.journal";
+}
+
+int ErrorStatsJournal::replay(Counters &stats, quint32 foldedGeneration, qint64 foldedBytes) {
+    if (file.fileName().isEmpty()) return 0;
+    if (file.isOpen()) file.close();
+    if (!file.open(QIODevice::ReadOnly)) return 0;
+    QByteArray data = file.readAll();
+    file.close();
+    if (data.size() < HeaderSize) return 0;
+    if (!std::equal(Magic, Magic + 4, data.constData())
+        || qFromLittleEndian<quint32>(data.constData() + 4) != AlphabetData::TableFingerprint) {
+        qDebug() << "Ignoring error-stats journal written for other kana tables:" << file.fileName();
+        return 0;
+    }
+    currentGeneration = qFromLittleEndian<quint32>(data.constData() + 8);
+    qint64 start = HeaderSize;
+    if (currentGeneration == foldedGeneration)
+        start = std::max(start, foldedBytes);
+    int applied = 0;
+    // A torn trailing record (crash mid-append) is simply dropped.
+    for (qint64 pos = start; pos + RecordSize <= data.size(); pos += RecordSize) {
+        const char *rec = data.constData() + pos;
+        quint16 id = qFromLittleEndian<quint16>(rec);
+        qint16 delta = qFromLittleEndian<qint16>(rec + 2);
+        if (id >= AlphabetData::CellCount) continue;
+        stats[id] = std::max(0, stats[id] + delta);
+        ++applied;
+    }
+    return applied;
+}
+
+bool ErrorStatsJournal::openForAppend() {
+    if (file.isOpen()) return true;
+    if (file.fileName().isEmpty() || !file.open(QIODevice::ReadWrite)) return false;
+    char header[HeaderSize];
+    bool valid = file.read(header, HeaderSize) == HeaderSize
+              && std::equal(Magic, Magic + 4, header)
+              && qFromLittleEndian<quint32>(header + 4) == AlphabetData::TableFingerprint;
+    if (valid) {
+        currentGeneration = qFromLittleEndian<quint32>(header + 8);
+    } else {
+        // New file, or a stale journal from other tables: start over rather than mix IDs.
+        currentGeneration = QRandomGenerator::global()->generate() | 1u;
+        std::copy(Magic, Magic + 4, header);
+        qToLittleEndian<quint32>(AlphabetData::TableFingerprint, header + 4);
+        qToLittleEndian<quint32>(currentGeneration, header + 8);
+        file.resize(0);
+        file.seek(0);
+        file.write(header, HeaderSize);
+    }
+    // Drop a torn trailing record so new records stay aligned.
+    qint64 end = HeaderSize + (file.size() - HeaderSize) / RecordSize * RecordSize;
+    if (end != file.size()) file.resize(end);
+    file.seek(end);
+    return true;
+}
+
+bool ErrorStatsJournal::append(AlphabetData::CharId id, int delta) {
+    if (delta == 0 || !openForAppend()) return false;
+    char rec[RecordSize];
+    qToLittleEndian<quint16>(id, rec);
+    qToLittleEndian<qint16>(static_cast<qint16>(delta), rec + 2);
+    qToLittleEndian<quint32>(static_cast<quint32>(QDateTime::currentSecsSinceEpoch()), rec + 4);
+    bool ok = file.write(rec, RecordSize) == RecordSize;
+    return file.flush() && ok;
+}
+
+qint64 ErrorStatsJournal::size() const {
+    return file.isOpen() ? file.size() : QFileInfo(file.fileName()).size();
+}
+
+bool ErrorStatsJournal::clear() {
+    if (file.fileName().isEmpty()) return false;
+    if (file.isOpen()) file.close();
+    currentGeneration = 0;
+    return !QFile::exists(file.fileName()) || QFile::remove(file.fileName());
+}
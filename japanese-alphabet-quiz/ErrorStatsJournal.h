@@ -0,0 +1,47 @@
+#ifndef ERRORSTATSJOURNAL_H
+#define ERRORSTATSJOURNAL_H
+
+#include <QFile>
+#include <QString>
+#include <array>
+#include "AlphabetData.h"
+
+// Append-only log of error-stat changes (charId, delta, timestamp) that
+// sits next to a profile's JSON snapshot. Each answer costs one 8-byte
+// sequential append instead of a full profile rewrite; the log is replayed
+// on load and folded back into the snapshot by compaction.
+//
+// File layout: "JQEJ", u32 AlphabetData::TableFingerprint, u32 generation,
+// then records of u16 charId, i16 delta, u32 unix seconds (little-endian).
+// A journal written against different tables is ignored, since its CharIds
+// would point at the wrong characters. The snapshot stores the generation
+// and size it has folded in, so a crash between writing the snapshot and
+// clearing the journal does not count those records twice.
+class ErrorStatsJournal {
+public:
+    using Counters = std::array<int, AlphabetData::CellCount>;
+    static constexpr qint64 CompactThreshold = 64 * 1024;
+
+    explicit ErrorStatsJournal(const QString &path = QString());
+    void setPath(const QString &path);
+    QString path() const { return file.fileName(); }
+    // Applies the journal on top of a snapshot, skipping the first
+    // `foldedBytes` if the snapshot already covers that generation.
+    // Returns the number of records applied.
+    int replay(Counters &stats, quint32 foldedGeneration = 0, qint64 foldedBytes = 0);
+    bool append(AlphabetData::CharId id, int delta);
+    qint64 size() const;
+    quint32 generation() const { return currentGeneration; }
+    bool needsCompaction() const { return size() >= CompactThreshold; }
+    // Call once the snapshot containing every journaled change is durable.
+    bool clear();
+
+    static QString pathForProfile(const QString &profileJsonPath);
+
+private:
+    bool openForAppend();
+    QFile file;
+    quint32 currentGeneration = 0;
+};
+
+#endif // ERRORSTATSJOURNAL_H
@@ -0,0 +1,103 @@
+#include "KanaComposer.h"
+#include "AnswerMatcher.h"
+#include "Romanizer.h"
+
+namespace {
+
+bool isVowel(char16_t c) {
+    return c == u'a' || c == u'i' || c == u'u' || c == u'e' || c == u'o';
+}
+
+bool isConsonant(char16_t c) {
+    return c >= u'a' && c <= u'z' && c != u'n' && !isVowel(c);
+}
+
+bool isRomaji(char16_t c) {
+    return (c >= u'a' && c <= u'z') || c == u'\'' || c == u'-';
+}
+
+} // namespace
+
+QString KanaComposer::type(QChar c) {
+    QString out;
+    const char16_t folded = AnswerMatcher::fold(c.unicode());
+    if (!isRomaji(folded)) {
+        settle(out, true);
+        out += c;
+        return out;
+    }
+    buffer += QChar(folded);
+    settle(out, false);
+    return out;
+}
+
+QString KanaComposer::flush() {
+    QString out;
+    settle(out, true);
+    return out;
+}
+
+bool KanaComposer::backspace() {
+    if (buffer.isEmpty()) return false;
+    buffer.chop(1);
+    return true;
+}
+
+// Settles the head of the buffer for as long as it is unambiguous; with
+// `final` set, nothing is left waiting for more keys.
+void KanaComposer::settle(QString &out, bool final) {
+    qsizetype done = 0;
+    while (done < buffer.size()) {
+        const QStringView rest = QStringView(buffer).mid(done);
+        const char16_t c = rest[0].unicode();
+        const char16_t next = rest.size() > 1 ? rest[1].unicode() : 0;
+        if (c == u'n' && next != u'y' && !isVowel(next)) {
+            if (next == 0 && !final) break;
+            if (next == u'\'') {
+                append(out, u"ん");
+                done += 2;
+                continue;
+            }
+            if (next == u'n') {
+                const char16_t third = rest.size() > 2 ? rest[2].unicode() : 0;
+                if (third == 0 && !final) break;
+                // In "konnichiwa" the second n starts に
+                append(out, u"ん");
+                done += third == u'y' || isVowel(third) ? 1 : 2;
+                continue;
+            }
+            append(out, u"ん");
+            ++done;
+            continue;
+        }
+        if (isConsonant(c) && (next == c || (c == u't' && next == u'c'))) {
+            append(out, u"っ");
+            ++done;
+            continue;
+        }
+        if (c == u'-') {
+            out += QChar(u'ー');
+            ++done;
+            continue;
+        }
+        const Romanizer::Match match = Romanizer::longestSpelling(rest);
+        if (match.open && !final) break;
+        if (match.length > 0) {
+            append(out, match.kana);
+            done += match.length;
+        } else {
+            // A stray letter is kept as typed; "ny" that goes nowhere is still ん
+            if (c == u'n') append(out, u"ん");
+            else out += QChar(c);
+            ++done;
+        }
+    }
+    buffer.remove(0, done);
+}
+
+void KanaComposer::append(QString &out, QStringView kana) const {
+    for (QChar c : kana) {
+        const char16_t u = c.unicode();
+        out += katakana && u >= u'ぁ' && u <= u'ゖ' ? QChar(char16_t(u + 0x60)) : c;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef KANACOMPOSER_H
+#define KANACOMPOSER_H
+#include <QString>
+#include <QStringView>
+
+// Turns romaji into kana one keystroke at a time, the way an IME does.
+// Letters stay pending until no further key can change their kana: "k" and
+// "ky" wait, "kya" settles as きゃ. nn, n' and n before a consonant are ん,
+// a doubled consonant (or tc) is っ and '-' is ー. Pending text is at most
+// one spelling long, so each keystroke costs O(1) table steps.
+class KanaComposer {
+public:
+    void setKatakana(bool on) { katakana = on; }
+    bool isKatakana() const { return katakana; }
+
+    // Feeds one typed character and returns the text it settles, which may
+    // be empty. Characters that are not romaji settle what is pending and
+    // pass through.
+    QString type(QChar c);
+    // Settles everything pending, e.g. a final n as ん, before an answer is checked.
+    QString flush();
+    // Drops the last pending letter; false if nothing was pending.
+    bool backspace();
+    void reset() { buffer.clear(); }
+    // Letters typed but not yet settled; they end the field's text.
+    const QString &pending() const { return buffer; }
+
+private:
+    void settle(QString &out, bool final);
+    void append(QString &out, QStringView kana) const;
+
+    QString buffer;
+    bool katakana = false;
+};
+
+#endif // KANACOMPOSER_H
@@ -0,0 +1,48 @@
+#include "KanaInput.h"
+
+KanaInput::KanaInput(QLineEdit *edit) : QObject(edit), edit(edit) {
+    connect(edit, &QLineEdit::textEdited, this, &KanaInput::onTextEdited);
+}
+
+void KanaInput::setActive(bool on) {
+    active = on;
+    composer.reset();
+    shown = edit->text();
+}
+
+void KanaInput::flush() {
+    if (composer.pending().isEmpty()) return;
+    shown.chop(composer.pending().size());
+    shown += composer.flush();
+    edit->setText(shown);
+}
+
+void KanaInput::clear() {
+    composer.reset();
+    shown.clear();
+    edit->clear();
+}
+
+void KanaInput::onTextEdited(const QString &text) {
+    if (!active) {
+        shown = text;
+        emit edited(text);
+        return;
+    }
+    const bool appended = text.size() == shown.size() + 1 && text.startsWith(shown)
+                          && edit->cursorPosition() == text.size();
+    if (appended) {
+        // The settled head stays; the pending tail is replaced by what it became
+        QString converted = shown.left(shown.size() - composer.pending().size());
+        converted += composer.type(text.back());
+        converted += composer.pending();
+        shown = converted;
+        if (shown != text) edit->setText(shown);
+    } else {
+        // Backspace over a pending letter keeps composing; any other edit starts afresh
+        const bool erased = text.size() + 1 == shown.size() && shown.startsWith(text);
+        if (!erased || !composer.backspace()) composer.reset();
+        shown = text;
+    }
+    emit edited(shown);
+}
@@ -0,0 +1,38 @@
+#ifndef KANAINPUT_H
+#define KANAINPUT_H
+
+#include <QLineEdit>
+#include <QObject>
+#include "KanaComposer.h"
+
+// Converts romaji typed into a line edit to kana as each key is pressed.
+// Only the unsettled letters at the end of the field are reworked, so a
+// keystroke costs the same however long the answer is. Listeners connect
+// to edited() rather than to the field, so they see the converted text.
+class KanaInput : public QObject {
+    Q_OBJECT
+public:
+    explicit KanaInput(QLineEdit *edit);
+
+    // When inactive the field's text is passed through untouched.
+    void setActive(bool on);
+    bool isActive() const { return active; }
+    void setKatakana(bool on) { composer.setKatakana(on); }
+    // Settles pending letters (a final n becomes ん) before the answer is read.
+    void flush();
+    // Clears the field and anything pending.
+    void clear();
+
+signals:
+    void edited(const QString &text);
+
+private:
+    void onTextEdited(const QString &text);
+
+    QLineEdit *edit;
+    KanaComposer composer;
+    QString shown; // the field's text after the last edit seen here
+    bool active = false;
+};
+
+#endif // KANAINPUT_H
@@ -2,11 +2,11 @@
 #include <QFont>
 #include <QIcon>
 
-MainMenuDialog::MainMenuDialog(const QString &profileName, QWidget *parent)
+MainMenuDialog::MainMenuDialog(const QString &profileName, int dueCount, QWidget *parent)
     : QDialog(parent), choice(Exit) {
     
     setWindowTitle("Japanese Learning - Main Menu");
-    setFixedSize(400, 340);
+    setFixedSize(400, 390);
     
 #ifdef Q_OS_WIN
     setWindowIcon(QIcon(":/appicon.ico"));
@@ -40,6 +40,8 @@ MainMenuDialog::MainMenuDialog(const QString &profileName, QWidget *parent)
     // Buttons
     alphabetQuizButton = new QPushButton("Alphabet Quiz", this);
     vocabulariesButton = new QPushButton("Vocabularies", this);
+    reviewDueButton = new QPushButton(QString("Review due (%1)").arg(dueCount), this);
+    reviewDueButton->setEnabled(dueCount > 0);
     exitButton = new QPushButton("Exit", this);
     
     // Style buttons
@@ -63,10 +65,12 @@ MainMenuDialog::MainMenuDialog(const QString &profileName, QWidget *parent)
     
     alphabetQuizButton->setStyleSheet(buttonStyle);
     vocabulariesButton->setStyleSheet(buttonStyle);
+    reviewDueButton->setStyleSheet(buttonStyle);
     exitButton->setStyleSheet(buttonStyle);
     
     mainLayout->addWidget(alphabetQuizButton);
     mainLayout->addWidget(vocabulariesButton);
+    mainLayout->addWidget(reviewDueButton);
     mainLayout->addSpacing(20);
     mainLayout->addWidget(exitButton);
     
@@ -75,6 +79,7 @@ MainMenuDialog::MainMenuDialog(const QString &profileName, QWidget *parent)
     // Connect signals
     connect(alphabetQuizButton, &QPushButton::clicked, this, &MainMenuDialog::onAlphabetQuizClicked);
     connect(vocabulariesButton, &QPushButton::clicked, this, &MainMenuDialog::onVocabulariesClicked);
+    connect(reviewDueButton, &QPushButton::clicked, this, &MainMenuDialog::onReviewDueClicked);
     connect(exitButton, &QPushButton::clicked, this, &MainMenuDialog::onExitClicked);
 }
 
@@ -88,6 +93,11 @@ void MainMenuDialog::onVocabulariesClicked() {
     accept();
 }
 
+void MainMenuDialog::onReviewDueClicked() {
+    choice = ReviewDue;
+    accept();
+}
+
 void MainMenuDialog::onExitClicked() {
     choice = Exit;
     reject();
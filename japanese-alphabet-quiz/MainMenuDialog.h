@@ -14,21 +14,25 @@ public:
     enum MenuChoice {
         AlphabetQuiz,
         Vocabularies,
+        ReviewDue,
         Exit
     };
 
-    explicit MainMenuDialog(const QString &profileName, QWidget *parent = nullptr);
+    // `dueCount` cards are due for spaced-repetition review.
+    explicit MainMenuDialog(const QString &profileName, int dueCount = 0, QWidget *parent = nullptr);
     MenuChoice getChoice() const { return choice; }
 
 private slots:
     void onAlphabetQuizClicked();
     void onVocabulariesClicked();
+    void onReviewDueClicked();
     void onExitClicked();
 
 private:
     MenuChoice choice;
     QPushButton *alphabetQuizButton;
     QPushButton *vocabulariesButton;
+    QPushButton *reviewDueButton;
     QPushButton *exitButton;
 };
 
@@ -0,0 +1,73 @@
+#include "PreferencesWriter.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <algorithm>
+
+PreferencesWriter::PreferencesWriter(Snapshot snapshot, int intervalMs, QObject *parent)
+    : QObject(parent), snapshot(std::move(snapshot)) {
+    timer.setSingleShot(true);
+    timer.setInterval(intervalMs);
+    connect(&timer, &QTimer::timeout, this, &PreferencesWriter::writeSnapshot);
+    // One thread keeps writes ordered: a newer snapshot never lands first.
+    writerPool.setMaxThreadCount(1);
+}
+
+PreferencesWriter::~PreferencesWriter() {
+    flush();
+}
+
+void PreferencesWriter::markDirty() {
+    {
+        QMutexLocker lock(&statsMutex);
+        ++counters.requests;
+    }
+    // Not restarted while pending: bursts coalesce into one write per interval.
+    if (!timer.isActive()) timer.start();
+}
+
+bool PreferencesWriter::flush() {
+    if (timer.isActive()) {
+        timer.stop();
+        writeSnapshot();
+    }
+    writerPool.waitForDone();
+    QMutexLocker lock(&statsMutex);
+    return lastWriteOk;
+}
+
+PreferencesWriter::Stats PreferencesWriter::stats() const {
+    QMutexLocker lock(&statsMutex);
+    return counters;
+}
+
+void PreferencesWriter::writeSnapshot() {
+    if (filePath.isEmpty() || !snapshot) return;
+    // The snapshot is taken on the owner's thread; QJsonObject is implicitly
+    // shared, so handing it to the worker is a reference-count bump.
+    QJsonObject doc = snapshot();
+    QString path = filePath;
+    // The destructor waits for the pool, so `this` outlives every task.
+    writerPool.start([this, doc, path]() {
+        QElapsedTimer elapsed;
+        elapsed.start();
+        QSaveFile file(path);
+        bool ok = file.open(QIODevice::WriteOnly | QIODevice::Text)
+               && file.write(QJsonDocument(doc).toJson(QJsonDocument::Indented)) >= 0
+               && file.commit();
+        qint64 micros = elapsed.nsecsElapsed() / 1000;
+        {
+            QMutexLocker lock(&statsMutex);
+            ++counters.writes;
+            if (!ok) ++counters.failures;
+            lastWriteOk = ok;
+            counters.lastWriteUs = micros;
+            counters.maxWriteUs = std::max(counters.maxWriteUs, micros);
+            counters.totalWriteUs += micros;
+        }
+        if (!ok) qDebug() << "Failed to write preferences:" << path;
+        QMetaObject::invokeMethod(this, [this, ok, micros]() { emit written(ok, micros); }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,57 @@
+#ifndef PREFERENCESWRITER_H
+#define PREFERENCESWRITER_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <functional>
+
+// Coalescing, write-behind JSON file writer. markDirty() is cheap and may
+// be called on every resize or checkbox toggle: at most one snapshot is
+// taken per interval, and it is written on a background thread through a
+// temp file + rename (QSaveFile), so the UI thread never blocks on disk.
+class PreferencesWriter : public QObject {
+    Q_OBJECT
+
+public:
+    using Snapshot = std::function<QJsonObject()>;
+
+    struct Stats {
+        int requests = 0;       // markDirty() calls
+        int writes = 0;         // files actually written
+        int failures = 0;
+        qint64 lastWriteUs = 0;
+        qint64 maxWriteUs = 0;
+        qint64 totalWriteUs = 0;
+    };
+
+    explicit PreferencesWriter(Snapshot snapshot, int intervalMs = 500, QObject *parent = nullptr);
+    ~PreferencesWriter() override;
+
+    void setFilePath(const QString &path) { filePath = path; }
+    QString path() const { return filePath; }
+    void markDirty();
+    // Writes any pending state and waits for background writes to finish.
+    // True if the latest write, and so the state it snapshotted, reached disk.
+    bool flush();
+    Stats stats() const;
+
+signals:
+    void written(bool ok, qint64 micros);
+
+private:
+    void writeSnapshot();
+
+    Snapshot snapshot;
+    QString filePath;
+    QTimer timer;
+    QThreadPool writerPool;
+    mutable QMutex statsMutex;
+    Stats counters;
+    bool lastWriteOk = true;
+};
+
+#endif // PREFERENCESWRITER_H
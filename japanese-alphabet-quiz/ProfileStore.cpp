@@ -0,0 +1,71 @@
+#include "ProfileStore.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+ProfileStore::ProfileStore(const QString &filePath, QObject *parent)
+    : QObject(parent), path(filePath), writer([this]() { return data; }, 500) {
+    writer.setFilePath(path);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return; // New profile
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        qDebug() << "Ignoring unreadable profile:" << path << err.errorString();
+        return;
+    }
+    data = doc.object();
+}
+
+ProfileStore::~ProfileStore() {
+    // The writer snapshots through `data`; write while it still exists
+    writer.flush();
+}
+
+QString ProfileStore::name() const {
+    return QFileInfo(path).baseName();
+}
+
+bool ProfileStore::boolValue(const QString &key, bool defaultValue) const {
+    return data.value(key).toBool(defaultValue);
+}
+
+int ProfileStore::intValue(const QString &key, int defaultValue) const {
+    return data.value(key).toInt(defaultValue);
+}
+
+bool ProfileStore::assign(const QString &key, const QJsonValue &value) {
+    auto it = data.find(key);
+    if (it != data.end() && it.value() == value) return false;
+    data.insert(key, value);
+    return true;
+}
+
+void ProfileStore::setValue(const QString &key, const QJsonValue &value) {
+    if (!assign(key, value)) return;
+    writer.markDirty();
+    emit changed(key);
+}
+
+void ProfileStore::setValues(const QJsonObject &values) {
+    bool dirty = false;
+    for (auto it = values.begin(); it != values.end(); ++it) {
+        if (!assign(it.key(), it.value())) continue;
+        dirty = true;
+        emit changed(it.key());
+    }
+    if (dirty) writer.markDirty();
+}
+
+void ProfileStore::remove(const QString &key) {
+    if (!data.contains(key)) return;
+    data.remove(key);
+    writer.markDirty();
+    emit changed(key);
+}
+
+bool ProfileStore::flush() {
+    return writer.flush();
+}
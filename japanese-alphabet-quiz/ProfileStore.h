@@ -0,0 +1,59 @@
+#ifndef PROFILESTORE_H
+#define PROFILESTORE_H
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QObject>
+#include <QString>
+#include "PreferencesWriter.h"
+
+class SqliteStore;
+
+// The one in-memory copy of a profile's JSON file, shared by every screen.
+// The file is read once; setters update memory and mark the profile dirty,
+// and a PreferencesWriter writes the whole object behind the UI. Screens
+// never read-modify-write the file themselves, so their keys cannot
+// overwrite each other.
+class ProfileStore : public QObject {
+    Q_OBJECT
+public:
+    explicit ProfileStore(const QString &filePath, QObject *parent = nullptr);
+    ~ProfileStore() override;
+
+    QString filePath() const { return path; }
+    // The profile name, i.e. the file's base name
+    QString name() const;
+    // Optional database for stats and scores (QUIZ_SQLITE_STORAGE builds);
+    // null when they live in JSON files.
+    SqliteStore *database() const { return db; }
+    void setDatabase(SqliteStore *database) { db = database; }
+    const QJsonObject &object() const { return data; }
+    bool contains(const QString &key) const { return data.contains(key); }
+    QJsonValue value(const QString &key) const { return data.value(key); }
+    // Typed getters fall back to `defaultValue` when the key is missing or of another type.
+    bool boolValue(const QString &key, bool defaultValue = false) const;
+    int intValue(const QString &key, int defaultValue = 0) const;
+    QJsonObject objectValue(const QString &key) const { return data.value(key).toObject(); }
+    QJsonArray arrayValue(const QString &key) const { return data.value(key).toArray(); }
+
+    // Setting a key to the value it already has does not schedule a write.
+    void setValue(const QString &key, const QJsonValue &value);
+    void setValues(const QJsonObject &values);
+    void remove(const QString &key);
+    // Writes pending changes now and waits for the write to finish; true if
+    // the file on disk holds them.
+    bool flush();
+
+signals:
+    void changed(const QString &key);
+
+private:
+    bool assign(const QString &key, const QJsonValue &value);
+
+    QString path;
+    QJsonObject data;
+    PreferencesWriter writer;
+    SqliteStore *db = nullptr;
+};
+
+#endif // PROFILESTORE_H
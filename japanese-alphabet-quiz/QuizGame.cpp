@@ -1,264 +1,296 @@
 #include "QuizGame.h"
-#include <QMap>
+#include "SessionRandom.h"
+#include "SrsScheduler.h"
+#ifdef QUIZ_SQLITE_STORAGE
+#include "SqliteStore.h"
+#endif
+#include <QDateTime>
 #include <QMessageBox>
 #include <QTimer>
-#include <algorithm>
-#include <random>
 
 QuizGame::QuizGame(QuizWindow *window) : QObject(window), window(window) {
-    // Load error stats from window
-    loadErrorStats();
+    ProfileStore *profile = window->profileStore();
+    bool statsInDatabase = false;
+#ifdef QUIZ_SQLITE_STORAGE
+    if (SqliteStore *db = profile->database()) {
+        // One row update per changed count; only a reset rewrites the profile's rows
+        QString name = profile->name();
+        engine.setErrorCountSink([db, name](CharId id, int errors) {
+            db->setCharErrors(name, AlphabetQuizEngine::errorStatsKey(id), errors);
+        });
+        engine.setSnapshotSink([db, name](const QJsonObject &stats, const QJsonObject &) {
+            return db->replaceCharErrors(name, stats);
+        });
+        engine.loadErrorStats(db->charErrors(name), QJsonObject());
+        statsInDatabase = true;
+    }
+#endif
+    if (!statsInDatabase) {
+        // The engine hands snapshots back here; the window owns the profile file
+        engine.setSnapshotSink([profile](const QJsonObject &stats, const QJsonObject &journalMark) {
+            if (stats.isEmpty()) profile->remove("error_stats");
+            else profile->setValue("error_stats", stats);
+            profile->setValue("error_stats_journal", journalMark);
+            return profile->flush();
+        });
+        // Load error stats from the profile, then replay the journal on top
+        engine.setJournalPath(ErrorStatsJournal::pathForProfile(profile->filePath()));
+        engine.loadErrorStats(profile->objectValue("error_stats"), profile->objectValue("error_stats_journal"));
+        connect(window, &QuizWindow::closing, &engine, &AlphabetQuizEngine::compactErrorStats);
+    }
+    connect(&engine, &AlphabetQuizEngine::cellMarked, this, &QuizGame::markCell);
+    connect(&engine, &AlphabetQuizEngine::roundStarted, window, &QuizWindow::resetTableHighlights);
     // Connect reset button
-    connect(window, &QuizWindow::resetHardCharactersRequested, this, &QuizGame::resetErrorStats);
-    connect(window->timesSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &QuizGame::newQuiz);
-    connect(window->hiraganaCB, &QCheckBox::checkStateChanged, [this](int state){ handleScriptCheckbox("hiragana", state); });
-    connect(window->katakanaCB, &QCheckBox::checkStateChanged, [this](int state){ handleScriptCheckbox("katakana", state); });
-    connect(window->kanjiCB, &QCheckBox::checkStateChanged, [this](int state){ handleScriptCheckbox("kanji", state); });
+    connect(window, &QuizWindow::resetHardCharactersRequested, &engine, &AlphabetQuizEngine::resetErrorStats);
+    connect(window, &QuizWindow::selectionChangeStarted, this, &QuizGame::beginSelectionChange);
+    connect(window, &QuizWindow::selectionChangeFinished, this, &QuizGame::endSelectionChange);
+    // Settings changed while preferences load are applied by the one rebuild at the end
+    connect(window->timesSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this]() {
+        if (!deferred()) newQuiz();
+    });
     connect(window->input, &QLineEdit::returnPressed, this, &QuizGame::checkAnswer);
-    for (auto cb : window->hiraganaRowChecks)
-        connect(cb, &QCheckBox::checkStateChanged, [this, cb](int state){ handleRowCheckbox("hiragana", cb, state); });
-    for (auto cb : window->katakanaRowChecks)
-        connect(cb, &QCheckBox::checkStateChanged, [this, cb](int state){ handleRowCheckbox("katakana", cb, state); });
-    for (auto cb : window->kanjiRowChecks)
-        connect(cb, &QCheckBox::checkStateChanged, [this, cb](int state){ handleRowCheckbox("kanji", cb, state); });
+    connect(window->kanaInput, &KanaInput::edited, this, &QuizGame::liveCheck);
+    connect(window->weightedPracticeCB, &QCheckBox::checkStateChanged, this, [this]() {
+        if (!deferred()) applyConfig();
+    });
+    connect(window->typeKanaCB, &QCheckBox::checkStateChanged, this, [this]() {
+        if (deferred()) return;
+        applyConfig();
+        CharId current = engine.current();
+        if (current == AlphabetData::InvalidChar) return;
+        // A kanji on screen is not asked in kana mode
+        if (!engine.asks(current)) afterSelectionChange();
+        else showQuestion();
+    });
+    for (int s = 0; s < AlphabetData::ScriptCount; ++s) {
+        auto script = static_cast<AlphabetData::Script>(s);
+        connect(window->scriptCheck(script), &QCheckBox::checkStateChanged, [this, script](int state){ handleScriptCheckbox(script, state); });
+        const auto &rowChecks = window->rowChecks(script);
+        for (int row = 0; row < static_cast<int>(rowChecks.size()); ++row)
+            connect(rowChecks[row], &QCheckBox::checkStateChanged, [this, script, row](int state){ handleRowCheckbox(script, row, state); });
+    }
+    engine.setEnabledChars(checkedChars());
     newQuiz();
 }
 
+void QuizGame::applyConfig() {
+    AlphabetQuizConfig config;
+    config.timesToShow = window->timesSpin->value();
+    config.weightedPractice = window->weightedPracticeCB->isChecked();
+    config.typeKana = window->typeKanaCB->isChecked();
+    engine.setConfig(config);
+    window->kanaInput->setActive(config.typeKana);
+    // Kanji are not asked in kana mode, so their table is shown as off
+    QTableWidget *kanjiTable = window->scriptTable(AlphabetData::Script::Kanji);
+    kanjiTable->setDisabled(!window->scriptCheck(AlphabetData::Script::Kanji)->isChecked() || config.typeKana);
+    kanjiTable->setToolTip(config.typeKana ? "Kanji are not asked when answering in kana" : QString());
+}
+
 void QuizGame::newQuiz() {
-    timesToShow = window->timesSpin->value();
-    roundChars.clear();
-    answeredOnce.clear();
-    charStatsCorrect.clear();
-    charStatsIncorrect.clear();
-    window->resetTableHighlights();
-    auto enabled = getEnabledAlphabets();
-    for (const auto &rows : enabled) {
-        for (const auto &entry : rows) {
-            if (!entry.kana.isEmpty()) {
-                for (int i = 0; i < timesToShow; ++i)
-                    roundChars.emplace_back(entry.kana, entry.romaji);
-            }
-        }
-    }
-    unansweredChars = roundChars;
-    correctCount = 0;
-    retryCount = 0;
-    window->updateScore(correctCount, retryCount);
+    applyConfig();
+    engine.newRound();
+    window->updateScore(engine.correctCount(), engine.retryCount());
     window->setChar("");
     window->setFeedback("");
-    window->setCountdown(static_cast<int>(unansweredChars.size()));
+    window->setCountdown(engine.totalRemaining());
     newQuestion();
 }
 
 void QuizGame::newQuestion(bool excludeCurrent) {
     window->setFeedback("");
-    window->setCountdown(static_cast<int>(unansweredChars.size()));
-    auto enabled = getEnabledAlphabets();
-    if (enabled.empty()) {
+    window->setCountdown(engine.totalRemaining());
+    switch (engine.nextQuestion(excludeCurrent)) {
+    case AlphabetQuizEngine::Draw::NothingEnabled:
         window->setChar("");
         window->setInputEnabled(false);
-        QMessageBox::warning(window, "No Script Selected", "Please select at least one script to practice.");
+        if (engine.enabledChars().any())
+            QMessageBox::warning(window, "No Kana Selected", "Kanji are not asked when answering in kana. Please select hiragana or katakana.");
+        else
+            QMessageBox::warning(window, "No Script Selected", "Please select at least one script to practice.");
         return;
-    } else {
+    case AlphabetQuizEngine::Draw::RoundComplete:
         window->setInputEnabled(true);
-    }
-    if (unansweredChars.empty()) {
-        std::vector<std::pair<QString, QString>> allChars;
-        for (const auto &rows : enabled) {
-            for (const auto &entry : rows) {
-                if (!entry.kana.isEmpty())
-                    allChars.emplace_back(entry.kana, entry.romaji);
-            }
-        }
-        showSummaryAndReset(allChars);
+        showSummaryAndReset();
         return;
+    case AlphabetQuizEngine::Draw::Drawn:
+        window->setInputEnabled(true);
+        break;
     }
-    std::vector<std::pair<QString, QString>> available = unansweredChars;
-    if (excludeCurrent && available.size() > 1) {
-        auto it = std::find(available.begin(), available.end(), std::make_pair(currentKana, currentRomaji));
-        if (it != available.end()) available.erase(it);
+    CharId chosen = engine.current();
+    const auto &cell = AlphabetData::Cells[chosen];
+    if (!engine.config().weightedPractice) {
+        printf("Standard %.*s (%.*s)\n", int(cell.kana.size()), cell.kana.data(), int(cell.romaji.size()), cell.romaji.data());
+    } else if (engine.errorCount(chosen) > 0) {
+        printf("Weighted: hard %.*s (%.*s)\n", int(cell.kana.size()), cell.kana.data(), int(cell.romaji.size()), cell.romaji.data());
+    } else {
+        printf("Weighted: standard %.*s (%.*s)\n", int(cell.kana.size()), cell.kana.data(), int(cell.romaji.size()), cell.romaji.data());
     }
-    // Weighted random selection if enabled
-    bool weighted = window->weightedPracticeCB && window->weightedPracticeCB->isChecked();
-    std::vector<double> weights;
-    int idx = 0;
-    std::random_device rd;
-    std::mt19937 g(rd());
-    if (weighted) {
-        for (const auto &pair : available) {
-            int err = errorStats.value(pair, 0);
-            weights.push_back(1.0 + err * 3.0); // base weight 1, +3 per error
-        }
-        if (!weights.empty()) {
-            std::discrete_distribution<> dist(weights.begin(), weights.end());
-            idx = dist(g);
-            // If the selected character has errorStats > 0, print Weighted: hard
-            if (errorStats.value(available[idx], 0) > 0) {
-                printf("Weighted: hard %s (%s)\n", available[idx].first.toStdString().c_str(), available[idx].second.toStdString().c_str());
-            } else {
-                printf("Weighted: standard %s (%s)\n", available[idx].first.toStdString().c_str(), available[idx].second.toStdString().c_str());
-            }
-        }
+    showQuestion();
+}
+
+// Puts the current character on screen: its kana, or in reverse its romaji
+// with the input set to the script that is expected.
+void QuizGame::showQuestion() {
+    CharId chosen = engine.current();
+    if (!engine.config().typeKana) {
+        window->setChar(AlphabetData::kanaText(chosen));
+        window->input->setPlaceholderText("Enter Romaji...");
     } else {
-        std::uniform_int_distribution<> dist(0, static_cast<int>(available.size()) - 1);
-        idx = dist(g);
-        printf("Standard %s (%s)\n", available[idx].first.toStdString().c_str(), available[idx].second.toStdString().c_str());
+        bool katakana = AlphabetData::Cells[chosen].script == AlphabetData::Script::Katakana;
+        window->kanaInput->setKatakana(katakana);
+        window->setChar(AlphabetData::romajiText(chosen));
+        window->input->setPlaceholderText(katakana ? "Type katakana (romaji is converted)..." : "Type hiragana (romaji is converted)...");
     }
-    auto chosen = available[idx];
-    currentKana = chosen.first;
-    currentRomaji = chosen.second;
-    window->setChar(currentKana);
     window->clearInput();
 }
 
 void QuizGame::checkAnswer() {
-    QString userInput = window->input->text().trimmed().toLower();
     window->setFeedback("");
-    if (userInput == currentRomaji) {
-        correctCount++;
-        answeredOnce.insert({currentKana, currentRomaji});
-        charStatsCorrect[{currentKana, currentRomaji}]++;
-        auto it = std::find(unansweredChars.begin(), unansweredChars.end(), std::make_pair(currentKana, currentRomaji));
-        if (it != unansweredChars.end()) {
-            unansweredChars.erase(it);
-            // If this was the last time for this character, mark green
-            bool stillInQuiz = false;
-            for (const auto &pair : unansweredChars) {
-                if (pair.first == currentKana && pair.second == currentRomaji) {
-                    stillInQuiz = true;
-                    break;
-                }
-            }
-            if (!stillInQuiz) {
-                window->highlightTableChar(currentKana, currentRomaji, "#4CAF50"); // green
-            }
-        }
-    // Decrease error count by 1 (min 0) on correct answer
-    auto key = std::make_pair(currentKana, currentRomaji);
-    int prevErr = errorStats.value(key, 0);
-    errorStats[key] = std::max(0, prevErr - 1);
-    saveErrorStats();
-        window->updateScore(correctCount, retryCount);
-        if (unansweredChars.size() > 1)
-            newQuestion(true);
-        else
-            newQuestion();
+    CharId asked = engine.current();
+    if (asked == AlphabetData::InvalidChar) return;
+    window->kanaInput->flush();
+    const bool correct = engine.answer(window->input->text());
+    if (srs) {
+        srs->review(SrsScheduler::kanaKey(asked), correct ? SrsScheduler::Grade::Good : SrsScheduler::Grade::Again,
+                    QDateTime::currentSecsSinceEpoch());
+    }
+    if (correct) {
+        window->updateScore(engine.correctCount(), engine.retryCount());
+        newQuestion(engine.totalRemaining() > 1);
     } else {
-        retryCount++;
-        charStatsIncorrect[{currentKana, currentRomaji}]++;
-    auto key = std::make_pair(currentKana, currentRomaji);
-    // increase error count by 2 on incorrect answer
-    errorStats[key] = errorStats.value(key, 0) + 2;
-        saveErrorStats();
-        window->highlightTableChar(currentKana, currentRomaji, "#F44336"); // red
-        window->setFeedback(QString("Incorrect! %1 = %2").arg(currentKana, currentRomaji), true);
-        window->updateScore(correctCount, retryCount);
+        if (engine.config().typeKana)
+            window->setFeedback(QString("Incorrect! %1 = %2").arg(AlphabetData::romajiText(asked), engine.currentKana()), true);
+        else
+            window->setFeedback(QString("Incorrect! %1 = %2").arg(AlphabetData::kanaText(asked), AlphabetData::romajiText(asked)), true);
+        window->updateScore(engine.correctCount(), engine.retryCount());
         // Show next question after a short delay
         QTimer::singleShot(700, this, [this]() {
-            if (unansweredChars.size() > 1)
-                newQuestion(true);
-            else
-                newQuestion();
+            newQuestion(engine.totalRemaining() > 1);
         });
     }
 }
 
-// --- Error stats persistence ---
-void QuizGame::loadErrorStats() {
-    errorStats.clear();
-    if (!window->errorStatsJson.isEmpty()) {
-        for (auto it = window->errorStatsJson.begin(); it != window->errorStatsJson.end(); ++it) {
-            QString key = it.key();
-            int val = it.value().toInt();
-            int sep = key.indexOf("|");
-            if (sep > 0) {
-                QString kana = key.left(sep);
-                QString romaji = key.mid(sep+1);
-                errorStats[{kana, romaji}] = val;
-            }
-        }
+void QuizGame::liveCheck(const QString &text) {
+    if (!window->liveFeedbackCB->isChecked()) return;
+    switch (engine.liveProgress(text)) {
+    case AnswerTrie::Progress::Mismatch:
+        window->setInputBorder("#e74c3c");
+        break;
+    case AnswerTrie::Progress::Prefix:
+        window->setInputBorder("");
+        break;
+    case AnswerTrie::Progress::Complete:
+        window->setInputBorder("#27ae60");
+        break;
+    case AnswerTrie::Progress::UniqueComplete:
+        window->setInputBorder("#27ae60");
+        // Submit once the edit has been delivered, unless Enter got there first
+        QTimer::singleShot(0, this, [this]() {
+            if (engine.liveProgress(window->input->text()) == AnswerTrie::Progress::UniqueComplete) checkAnswer();
+        });
+        break;
     }
 }
 
-void QuizGame::saveErrorStats() {
-    QJsonObject obj;
-    for (auto it = errorStats.begin(); it != errorStats.end(); ++it) {
-        QString key = it.key().first + "|" + it.key().second;
-        obj[key] = it.value();
+void QuizGame::markCell(CharId id, AlphabetQuizEngine::Mark mark) {
+    switch (mark) {
+    case AlphabetQuizEngine::Mark::Completed: window->highlightTableChar(id, "#4CAF50"); break; // green
+    case AlphabetQuizEngine::Mark::Missed: window->highlightTableChar(id, "#F44336"); break; // red
+    case AlphabetQuizEngine::Mark::Cleared: window->clearTableHighlight(id); break;
     }
-    window->errorStatsJson = obj;
-    window->savePreferences();
 }
 
-void QuizGame::resetErrorStats() {
-    errorStats.clear();
-    saveErrorStats();
-}
-
-void QuizGame::handleScriptCheckbox(const QString &script, int state) {
-    if (script == "hiragana") window->hiraganaTable->setDisabled(state == 0);
-    if (script == "katakana") window->katakanaTable->setDisabled(state == 0);
-    if (script == "kanji") window->kanjiTable->setDisabled(state == 0);
-    newQuiz();
+// --- Character selection ---
+// A single toggle only touches the cells of that row or script and adjusts
+// the running round in place; bulk changes (loading preferences, select
+// all) are bracketed and rebuilt once.
+void QuizGame::handleScriptCheckbox(AlphabetData::Script script, int state) {
+    window->scriptTable(script)->setDisabled(state == 0 || (script == AlphabetData::Script::Kanji && engine.config().typeKana));
+    if (deferred()) return;
+    const auto &rowChecks = window->rowChecks(script);
+    for (int row = 0; row < static_cast<int>(rowChecks.size()); ++row) {
+        const AlphabetData::RowSpan &span = AlphabetData::rowSpan(script, row);
+        engine.setCellsEnabled(span.firstCell, span.cellCount, state != 0 && rowChecks[row]->isChecked());
+    }
+    afterSelectionChange();
 }
-void QuizGame::handleRowCheckbox(const QString &script, QCheckBox *cb, int state) {
-    std::vector<QCheckBox*> *rowChecks = nullptr;
-    if (script == "hiragana") rowChecks = &window->hiraganaRowChecks;
-    if (script == "katakana") rowChecks = &window->katakanaRowChecks;
-    if (script == "kanji") rowChecks = &window->kanjiRowChecks;
-    if (!rowChecks) return;
+void QuizGame::handleRowCheckbox(AlphabetData::Script script, int row, int state) {
+    if (deferred()) return;
+    const auto &rowChecks = window->rowChecks(script);
     if (state == 0) {
+        // Keep at least one row of each script selected
         int checked = 0;
-        for (auto c : *rowChecks) if (c->isChecked()) ++checked;
+        for (auto c : rowChecks) if (c->isChecked()) ++checked;
         if (checked == 0) {
+            QCheckBox *cb = rowChecks[row];
             cb->blockSignals(true);
             cb->setChecked(true);
             cb->blockSignals(false);
             return;
         }
     }
-    newQuiz();
+    const AlphabetData::RowSpan &span = AlphabetData::rowSpan(script, row);
+    engine.setCellsEnabled(span.firstCell, span.cellCount, state != 0 && window->scriptCheck(script)->isChecked());
+    afterSelectionChange();
 }
-void QuizGame::updateScore() {
-    window->updateScore(correctCount, retryCount);
+void QuizGame::beginSelectionChange() {
+    ++selectionDepth;
 }
-std::vector<std::vector<KanaEntry>> QuizGame::getEnabledAlphabets() const {
-    std::vector<std::vector<KanaEntry>> enabled;
-    auto getCheckedRows = [](const std::vector<QCheckBox*> &rowChecks, const std::vector<std::vector<KanaEntry>> &alphabet) {
-        std::vector<KanaEntry> chars;
-        for (size_t row = 0; row < rowChecks.size(); ++row) {
-            if (rowChecks[row]->isChecked()) {
-                for (const auto &entry : alphabet[row]) {
-                    if (!entry.kana.isEmpty()) chars.push_back(entry);
-                }
-            }
-        }
-        return chars;
-    };
-    if (window->hiraganaCB->isChecked()) enabled.push_back(getCheckedRows(window->hiraganaRowChecks, AlphabetData::Hiragana));
-    if (window->katakanaCB->isChecked()) enabled.push_back(getCheckedRows(window->katakanaRowChecks, AlphabetData::Katakana));
-    if (window->kanjiCB->isChecked()) enabled.push_back(getCheckedRows(window->kanjiRowChecks, AlphabetData::Kanji));
-    return enabled;
+// Inside a bulk change, notes that the end has to rebuild instead.
+bool QuizGame::deferred() {
+    if (selectionDepth == 0) return false;
+    selectionDirty = true;
+    return true;
 }
-void QuizGame::showSummaryAndReset(const std::vector<std::pair<QString, QString>> &allChars) {
-    int right = 0, wrong = 0;
-    QStringList hardChars;
-    for (const auto &charTuple : allChars) {
-        int incorrect = charStatsIncorrect[charTuple];
-        if (incorrect > 0) {
-            ++wrong;
-            if (incorrect > 1)
-                hardChars << QString("%1 (%2)").arg(charTuple.first, charTuple.second);
-        } else {
-            ++right;
+void QuizGame::endSelectionChange() {
+    if (selectionDepth == 0 || --selectionDepth > 0) return;
+    if (!selectionDirty) return;
+    selectionDirty = false;
+    engine.setEnabledChars(checkedChars());
+    newQuiz();
+}
+// Full rescan of the checkboxes, for construction and after bulk changes.
+AlphabetQuizEngine::CharSet QuizGame::checkedChars() const {
+    AlphabetQuizEngine::CharSet chars;
+    for (int s = 0; s < AlphabetData::ScriptCount; ++s) {
+        auto script = static_cast<AlphabetData::Script>(s);
+        if (!window->scriptCheck(script)->isChecked()) continue;
+        const auto &rowChecks = window->rowChecks(script);
+        for (int row = 0; row < static_cast<int>(rowChecks.size()); ++row) {
+            if (!rowChecks[row]->isChecked()) continue;
+            const AlphabetData::RowSpan &span = AlphabetData::rowSpan(script, row);
+            for (int id = span.firstCell; id < span.firstCell + span.cellCount; ++id)
+                chars.set(static_cast<CharId>(id));
         }
     }
-    QString msg = QString("Quiz Complete!\n\nCorrect: %1\nIncorrect: %2").arg(right).arg(wrong);
+    return chars;
+}
+void QuizGame::afterSelectionChange() {
+    window->setCountdown(engine.totalRemaining());
+    // Move on if the character on screen was just deselected, or if the
+    // remaining characters were all deselected.
+    CharId current = engine.current();
+    if (!engine.hasAskedChars() || engine.roundComplete()) {
+        newQuiz();
+    } else if (current == AlphabetData::InvalidChar || !engine.asks(current)) {
+        newQuestion();
+    }
+}
+void QuizGame::updateScore() {
+    window->updateScore(engine.correctCount(), engine.retryCount());
+}
+void QuizGame::showSummaryAndReset() {
+    AlphabetQuizEngine::RoundSummary summary = engine.roundSummary();
+    QStringList hardChars;
+    for (CharId id : summary.hard)
+        hardChars << QString("%1 (%2)").arg(AlphabetData::kanaText(id), AlphabetData::romajiText(id));
+    QString msg = QString("Quiz Complete!\n\nCorrect: %1\nIncorrect: %2").arg(summary.right).arg(summary.wrong);
     if (!hardChars.isEmpty()) {
         msg += "\n\nYou should work on these characters (missed more than once):\n" + hardChars.join("\n");
     } else {
         msg += "\n\nGreat job!";
     }
+    msg += QString("\n\nSession seed: %1").arg(SessionRandom::seed());
     QMessageBox::information(window, "Quiz Summary", msg);
     window->resetTableHighlights();
     newQuiz();
@@ -1,13 +1,16 @@
 #ifndef QUIZGAME_H
 #define QUIZGAME_H
 #include <QObject>
-#include <QMap>
 #include <vector>
-#include <set>
-#include <map>
 #include "QuizWindow.h"
 #include "AlphabetData.h"
+#include "AlphabetQuizEngine.h"
 
+class SrsScheduler;
+
+using AlphabetData::CharId;
+
+// Connects QuizWindow's widgets to an AlphabetQuizEngine.
 class QuizGame : public QObject {
     Q_OBJECT
 public:
@@ -15,26 +18,30 @@ public:
     void newQuiz();
     void newQuestion(bool excludeCurrent = false);
     void checkAnswer();
-    void handleScriptCheckbox(const QString &script, int state);
-    void handleRowCheckbox(const QString &script, QCheckBox *cb, int state);
+    // Colors the input against the current answer; submits a complete one.
+    void liveCheck(const QString &text);
+    void handleScriptCheckbox(AlphabetData::Script script, int state);
+    void handleRowCheckbox(AlphabetData::Script script, int row, int state);
+    // Checkbox and setting changes between begin/end are applied as one rebuild.
+    void beginSelectionChange();
+    void endSelectionChange();
     void updateScore();
-    void showSummaryAndReset(const std::vector<std::pair<QString, QString>> &allChars);
-    std::vector<std::vector<KanaEntry>> getEnabledAlphabets() const;
-    void loadErrorStats();
-    void saveErrorStats();
-    void resetErrorStats();
+    void showSummaryAndReset();
+    void applyConfig();
+    AlphabetQuizEngine &quizEngine() { return engine; }
+    // Every answer is also graded into `scheduler` (may be null); it must outlive the game.
+    void setScheduler(SrsScheduler *scheduler) { srs = scheduler; }
 private:
+    AlphabetQuizEngine::CharSet checkedChars() const;
+    bool deferred();
+    void afterSelectionChange();
+    void showQuestion();
+    void markCell(CharId id, AlphabetQuizEngine::Mark mark);
     QuizWindow *window;
-    int correctCount = 0;
-    int retryCount = 0;
-    QString currentKana, currentRomaji;
-    std::vector<std::pair<QString, QString>> roundChars;
-    std::vector<std::pair<QString, QString>> unansweredChars;
-    std::set<std::pair<QString, QString>> answeredOnce;
-    std::map<std::pair<QString, QString>, int> charStatsCorrect;
-    std::map<std::pair<QString, QString>, int> charStatsIncorrect;
-    int timesToShow = 1;
-    QMap<std::pair<QString, QString>, int> errorStats;
+    AlphabetQuizEngine engine;
+    int selectionDepth = 0;
+    bool selectionDirty = false;
+    SrsScheduler *srs = nullptr;
 };
 
 #endif // QUIZGAME_H
@@ -5,11 +5,14 @@
 #include <QDir>
 #include <QHeaderView>
 #include <QJsonArray>
+#include <QMenu>
+#include <algorithm>
 
 #include <QEvent>
+#include <QCloseEvent>
 
 
-QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
+QuizWindow::QuizWindow(ProfileStore *profile, QWidget *parent) : QWidget(parent), profile(profile) {
 #ifdef Q_OS_WIN
     setWindowIcon(QIcon(":/appicon.ico"));
 #else
@@ -18,7 +21,6 @@ QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
 
     setWindowTitle("Japanese Alphabet Quiz");
     setGeometry(100, 100, 1200, 700);
-    prefsFile = QDir::currentPath() + "/japanese_alphabet_quiz_prefs.json";
 
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
@@ -41,12 +43,24 @@ QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
     weightedPracticeCB->setChecked(false);
     mainLayout->addWidget(weightedPracticeCB);
 
+    // Color the answer field while typing and submit a complete answer
+    liveFeedbackCB = new QCheckBox("Live feedback while typing", this);
+    liveFeedbackCB->setChecked(false);
+    mainLayout->addWidget(liveFeedbackCB);
+
+    // Reverse quiz: the romaji is shown and the kana typed
+    typeKanaCB = new QCheckBox("Show romaji, answer in kana", this);
+    typeKanaCB->setChecked(false);
+    mainLayout->addWidget(typeKanaCB);
+
     // Reset hard characters button
     resetHardCharsButton = new QPushButton("Reset Hard Characters", this);
     mainLayout->addWidget(resetHardCharsButton);
 
     // Now connect signals for widgets that are initialized
     connect(weightedPracticeCB, &QCheckBox::checkStateChanged, this, &QuizWindow::savePreferences);
+    connect(liveFeedbackCB, &QCheckBox::checkStateChanged, this, &QuizWindow::savePreferences);
+    connect(typeKanaCB, &QCheckBox::checkStateChanged, this, &QuizWindow::savePreferences);
     connect(resetHardCharsButton, &QPushButton::clicked, this, [this]() {
         Q_EMIT resetHardCharactersRequested();
     });
@@ -56,7 +70,7 @@ QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
     timesLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
     timesSpin = new QSpinBox(this);
     timesSpin->setMinimum(1);
-    timesSpin->setMaximum(20);
+    timesSpin->setMaximum(1000);
     timesSpin->setValue(1);
     timesSpin->setFixedWidth(60);
     timesLayout->addWidget(timesLabel);
@@ -65,11 +79,10 @@ QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
     connect(timesSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &QuizWindow::savePreferences);
 
     QHBoxLayout *tablesLayout = new QHBoxLayout();
-    auto createTable = [this](const std::vector<std::vector<KanaEntry>> &alphabet, std::vector<QCheckBox*> &rowChecks, const QString &title) {
-        int n = static_cast<int>(alphabet.size());
-        int maxRowLen = 0;
-        for (const auto &row : alphabet) maxRowLen = std::max(maxRowLen, static_cast<int>(row.size()));
-        QTableWidget *table = new QTableWidget(n, maxRowLen + 1);
+    auto createTable = [this](AlphabetData::Script script, std::vector<QCheckBox*> &rowChecks, const QString &title) {
+        const AlphabetData::ScriptInfo &info = AlphabetData::scriptInfo(script);
+        int n = info.rowCount;
+        QTableWidget *table = new QTableWidget(n, info.columnCount + 1);
         table->horizontalHeader()->setVisible(false);
         table->verticalHeader()->setVisible(false);
         table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
@@ -89,14 +102,18 @@ QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
             // Connect row checkbox to savePreferences
             QObject::connect(cb, &QCheckBox::checkStateChanged, this, &QuizWindow::savePreferences);
         }
-        for (int row = 0; row < n; ++row) {
-            for (int col = 0; col < static_cast<int>(alphabet[row].size()); ++col) {
-                const auto &entry = alphabet[row][col];
-                if (entry.kana.isEmpty()) continue;
-                QTableWidgetItem *item = new QTableWidgetItem(entry.kana + " (" + entry.romaji + ")");
-                item->setFont(font);
-                table->setItem(row, col + 1, item);
-            }
+        table->setContextMenuPolicy(Qt::CustomContextMenu);
+        QObject::connect(table, &QTableWidget::customContextMenuRequested, this, [this, table, script](const QPoint &pos) {
+            QMenu menu;
+            menu.addAction("Select all rows", this, [this, script]() { selectAllRows(script); });
+            menu.exec(table->viewport()->mapToGlobal(pos));
+        });
+        for (int id = info.firstCell; id < info.firstCell + info.cellCount; ++id) {
+            const auto &cell = AlphabetData::Cells[id];
+            QTableWidgetItem *item = new QTableWidgetItem(AlphabetData::kanaText(id) + " (" + AlphabetData::romajiText(id) + ")");
+            item->setFont(font);
+            table->setItem(cell.row, cell.col + 1, item);
+            cellItems[id] = item;
         }
         table->setEditTriggers(QTableWidget::NoEditTriggers);
         table->setSelectionMode(QTableWidget::NoSelection);
@@ -104,9 +121,9 @@ QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
         table->resizeRowsToContents();
         return table;
     };
-    hiraganaTable = createTable(AlphabetData::Hiragana, hiraganaRowChecks, "Hiragana");
-    katakanaTable = createTable(AlphabetData::Katakana, katakanaRowChecks, "Katakana");
-    kanjiTable = createTable(AlphabetData::Kanji, kanjiRowChecks, "Kanji");
+    hiraganaTable = createTable(AlphabetData::Script::Hiragana, hiraganaRowChecks, "Hiragana");
+    katakanaTable = createTable(AlphabetData::Script::Katakana, katakanaRowChecks, "Katakana");
+    kanjiTable = createTable(AlphabetData::Script::Kanji, kanjiRowChecks, "Kanji");
     tablesLayout->addWidget(hiraganaTable);
     tablesLayout->addWidget(katakanaTable);
     tablesLayout->addWidget(kanjiTable);
@@ -167,6 +184,7 @@ QuizWindow::QuizWindow(QWidget *parent) : QWidget(parent) {
     input = new QLineEdit(this);
     input->setPlaceholderText("Enter Romaji...");
     mainLayout->addWidget(input);
+    kanaInput = new KanaInput(input);
 
     setLayout(mainLayout);
 
@@ -186,7 +204,24 @@ bool QuizWindow::eventFilter(QObject *obj, QEvent *event) {
     return QWidget::eventFilter(obj, event);
 }
 
+QuizWindow::~QuizWindow() {
+    profile->flush();
+}
+
+void QuizWindow::closeEvent(QCloseEvent *event) {
+    Q_EMIT closing();
+    profile->flush();
+    QWidget::closeEvent(event);
+}
+
+// Resizes and checkbox toggles land here; unchanged keys cost nothing and
+// the profile store coalesces the file writes.
 void QuizWindow::savePreferences() {
+    profile->setValues(preferencesJson());
+}
+
+QJsonObject QuizWindow::preferencesJson() const {
+    // Only this window's keys; the rest of the profile is left alone
     QJsonObject prefs;
     // Script checkboxes
     prefs["hiragana_cb"] = hiraganaCB->isChecked();
@@ -214,29 +249,16 @@ void QuizWindow::savePreferences() {
 
     // Save weighted practice option
     prefs["weighted_practice"] = weightedPracticeCB->isChecked();
+    prefs["live_feedback"] = liveFeedbackCB->isChecked();
+    prefs["type_kana"] = typeKanaCB->isChecked();
 
-    // Save error stats if present (to be filled by QuizGame)
-    if (errorStatsJson.size() > 0) {
-        prefs["error_stats"] = errorStatsJson;
-    }
-
-    QFile file(prefsFile);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QJsonDocument doc(prefs);
-        file.write(doc.toJson(QJsonDocument::Indented));
-        file.close();
-    }
+    return prefs;
 }
 void QuizWindow::loadPreferences() {
-    QFile file(prefsFile);
-    if (!file.exists()) return;
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
-    QByteArray data = file.readAll();
-    file.close();
-    QJsonParseError err;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-    if (err.error != QJsonParseError::NoError || !doc.isObject()) return;
-    QJsonObject prefs = doc.object();
+    // A copy: applying each setting below saves the window state back
+    QJsonObject prefs = profile->object();
+    if (prefs.isEmpty()) return;
+    Q_EMIT selectionChangeStarted();
 
     // Script checkboxes
     if (prefs.contains("hiragana_cb")) hiraganaCB->setChecked(prefs["hiragana_cb"].toBool(true));
@@ -245,9 +267,10 @@ void QuizWindow::loadPreferences() {
     if (prefs.contains("hide_tables_cb")) hideTablesCB->setChecked(prefs["hide_tables_cb"].toBool(false));
 
     // Row checkboxes
+    // Rows added since the preferences were saved (e.g. yōon) start unchecked
     auto setRowChecks = [](const QJsonArray &arr, std::vector<QCheckBox*> &checks) {
-        int n = std::min(static_cast<int>(arr.size()), static_cast<int>(checks.size()));
-        for (int i = 0; i < n; ++i) checks[i]->setChecked(arr[i].toBool(true));
+        for (int i = 0; i < static_cast<int>(checks.size()); ++i)
+            checks[i]->setChecked(i < arr.size() && arr[i].toBool(true));
     };
     if (prefs.contains("hiragana_rows") && prefs["hiragana_rows"].isArray())
         setRowChecks(prefs["hiragana_rows"].toArray(), hiraganaRowChecks);
@@ -263,17 +286,13 @@ void QuizWindow::loadPreferences() {
     }
     // Weighted practice
     if (prefs.contains("weighted_practice")) weightedPracticeCB->setChecked(prefs["weighted_practice"].toBool(false));
-    // Load error stats if present
-    if (prefs.contains("error_stats") && prefs["error_stats"].isObject()) {
-        errorStatsJson = prefs["error_stats"].toObject();
-    } else {
-        errorStatsJson = QJsonObject();
-    }
-
+    if (prefs.contains("live_feedback")) liveFeedbackCB->setChecked(prefs["live_feedback"].toBool(false));
+    if (prefs.contains("type_kana")) typeKanaCB->setChecked(prefs["type_kana"].toBool(false));
     // Disable tables if their script checkbox is not checked
     hiraganaTable->setDisabled(!hiraganaCB->isChecked());
     katakanaTable->setDisabled(!katakanaCB->isChecked());
-    kanjiTable->setDisabled(!kanjiCB->isChecked());
+    kanjiTable->setDisabled(!kanjiCB->isChecked() || typeKanaCB->isChecked()); // kanji are not asked in kana
+    Q_EMIT selectionChangeFinished();
 
     // Window size
     if (prefs.contains("window_size") && prefs["window_size"].isArray()) {
@@ -296,42 +315,67 @@ void QuizWindow::setFeedback(const QString &msg, bool error) {
     feedbackLabel->setStyleSheet(error ? "color: red;" : "color: green;");
 }
 void QuizWindow::clearInput() {
-    input->clear();
+    kanaInput->clear();
+    setInputBorder("");
+}
+void QuizWindow::setInputBorder(const QString &color) {
+    if (color == inputBorderColor) return; // restyling is the costly part
+    inputBorderColor = color;
+    input->setStyleSheet(color.isEmpty() ? QString() : QString("border: 2px solid %1;").arg(color));
 }
 void QuizWindow::setInputEnabled(bool enabled) {
     input->setEnabled(enabled);
 }
-void QuizWindow::highlightTableChar(const QString &kana, const QString &romaji, const QString &color) {
-    auto highlight = [&](QTableWidget *table, const std::vector<std::vector<KanaEntry>> &alphabet) {
-        for (int row = 0; row < static_cast<int>(alphabet.size()); ++row) {
-            for (int col = 0; col < static_cast<int>(alphabet[row].size()); ++col) {
-                const auto &entry = alphabet[row][col];
-                if (entry.kana == kana && entry.romaji == romaji) {
-                    QTableWidgetItem *item = table->item(row, col + 1);
-                    if (item) item->setBackground(QColor(color));
-                }
-            }
-        }
-    };
-    highlight(hiraganaTable, AlphabetData::Hiragana);
-    highlight(katakanaTable, AlphabetData::Katakana);
-    highlight(kanjiTable, AlphabetData::Kanji);
+void QuizWindow::highlightTableChar(AlphabetData::CharId id, const QString &color) {
+    QTableWidgetItem *item = cellItems[id];
+    if (!item) return;
+    item->setBackground(QColor(color));
+    if (!highlighted[id]) {
+        highlighted.set(id);
+        highlightedCells.push_back(id);
+    }
+}
+void QuizWindow::clearTableHighlight(AlphabetData::CharId id) {
+    if (!highlighted[id]) return;
+    highlighted.reset(id);
+    highlightedCells.erase(std::find(highlightedCells.begin(), highlightedCells.end(), id));
+    cellItems[id]->setBackground(Qt::NoBrush);
 }
+// Clears only the colored cells. Table updates are suspended meanwhile so
+// each table repaints once instead of once per cell.
 void QuizWindow::resetTableHighlights() {
-    auto reset = [](QTableWidget *table) {
-        for (int row = 0; row < table->rowCount(); ++row) {
-            for (int col = 1; col < table->columnCount(); ++col) {
-                QTableWidgetItem *item = table->item(row, col);
-                if (item) item->setBackground(Qt::NoBrush);
-            }
-        }
-    };
-    reset(hiraganaTable);
-    reset(katakanaTable);
-    reset(kanjiTable);
+    if (highlightedCells.empty()) return;
+    bool touched[AlphabetData::ScriptCount] = {};
+    for (AlphabetData::CharId id : highlightedCells)
+        touched[static_cast<int>(AlphabetData::Cells[id].script)] = true;
+    for (int s = 0; s < AlphabetData::ScriptCount; ++s)
+        if (touched[s]) scriptTable(static_cast<AlphabetData::Script>(s))->setUpdatesEnabled(false);
+    for (AlphabetData::CharId id : highlightedCells)
+        cellItems[id]->setBackground(Qt::NoBrush);
+    highlightedCells.clear();
+    highlighted.reset();
+    for (int s = 0; s < AlphabetData::ScriptCount; ++s)
+        if (touched[s]) scriptTable(static_cast<AlphabetData::Script>(s))->setUpdatesEnabled(true);
 }
 std::vector<bool> QuizWindow::getRowChecks(const std::vector<QCheckBox*> &checks) const {
     std::vector<bool> res;
     for (auto cb : checks) res.push_back(cb->isChecked());
     return res;
 }
+QCheckBox *QuizWindow::scriptCheck(AlphabetData::Script script) const {
+    QCheckBox *checks[] = {hiraganaCB, katakanaCB, kanjiCB};
+    return checks[static_cast<int>(script)];
+}
+QTableWidget *QuizWindow::scriptTable(AlphabetData::Script script) const {
+    QTableWidget *tables[] = {hiraganaTable, katakanaTable, kanjiTable};
+    return tables[static_cast<int>(script)];
+}
+const std::vector<QCheckBox*> &QuizWindow::rowChecks(AlphabetData::Script script) const {
+    const std::vector<QCheckBox*> *checks[] = {&hiraganaRowChecks, &katakanaRowChecks, &kanjiRowChecks};
+    return *checks[static_cast<int>(script)];
+}
+void QuizWindow::selectAllRows(AlphabetData::Script script) {
+    Q_EMIT selectionChangeStarted();
+    for (auto cb : rowChecks(script)) cb->setChecked(true);
+    Q_EMIT selectionChangeFinished();
+}
@@ -10,38 +10,66 @@
 #include <QPushButton>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
+#include <array>
+#include <bitset>
 #include <vector>
 #include "AlphabetData.h"
+#include "KanaInput.h"
+#include "ProfileStore.h"
 
 class QuizWindow : public QWidget {
     Q_OBJECT
 public:
-    explicit QuizWindow(QWidget *parent = nullptr);
+    // `profile` must outlive the window.
+    explicit QuizWindow(ProfileStore *profile, QWidget *parent = nullptr);
+    ~QuizWindow() override;
     void savePreferences();
+    QJsonObject preferencesJson() const;
     void loadPreferences();
     void updateScore(int correct, int retries);
     void setChar(const QString &kana);
     void setFeedback(const QString &msg, bool error = false);
     void clearInput();
+    // Empty color restores the default frame
+    void setInputBorder(const QString &color);
     void setInputEnabled(bool enabled);
-    void highlightTableChar(const QString &kana, const QString &romaji, const QString &color);
+    void highlightTableChar(AlphabetData::CharId id, const QString &color);
+    void clearTableHighlight(AlphabetData::CharId id);
     void resetTableHighlights();
     std::vector<bool> getRowChecks(const std::vector<QCheckBox*> &checks) const;
+    QCheckBox *scriptCheck(AlphabetData::Script script) const;
+    QTableWidget *scriptTable(AlphabetData::Script script) const;
+    const std::vector<QCheckBox*> &rowChecks(AlphabetData::Script script) const;
+    // Checks every row of a script as one selection change.
+    void selectAllRows(AlphabetData::Script script);
     QTableWidget *hiraganaTable, *katakanaTable, *kanjiTable;
     std::vector<QCheckBox*> hiraganaRowChecks, katakanaRowChecks, kanjiRowChecks;
-    QCheckBox *hiraganaCB, *katakanaCB, *kanjiCB, *hideTablesCB, *weightedPracticeCB;
+    QCheckBox *hiraganaCB, *katakanaCB, *kanjiCB, *hideTablesCB, *weightedPracticeCB, *liveFeedbackCB, *typeKanaCB;
     QPushButton *resetHardCharsButton;
     QSpinBox *timesSpin;
     QLabel *scoreLabel, *charLabel, *feedbackLabel, *timesLabel, *countdownLabel;
     void setCountdown(int remaining);
     QLineEdit *input;
-    QString prefsFile;
+    KanaInput *kanaInput; // romaji -> kana while typing kana answers
+    ProfileStore *profileStore() const { return profile; }
     QFont scoreFont, charFont;
-        QJsonObject errorStatsJson; // Declare errorStatsJson as a member
     signals:
         void resetHardCharactersRequested(); // Signal for reset button
+        void closing(); // Emitted before pending preferences are flushed
+        // Bracket bulk checkbox changes so listeners can rebuild once at the end
+        void selectionChangeStarted();
+        void selectionChangeFinished();
+    private:
+        ProfileStore *profile;
+        // Table item for each CharId, filled when the tables are built
+        std::array<QTableWidgetItem*, AlphabetData::CellCount> cellItems{};
+        // Cells currently colored, so a reset only touches those
+        std::vector<AlphabetData::CharId> highlightedCells;
+        std::bitset<AlphabetData::CellCount> highlighted;
+        QString inputBorderColor;
     protected:
         bool eventFilter(QObject *obj, QEvent *event) override;
+        void closeEvent(QCloseEvent *event) override;
 };
 
 #endif // QUIZWINDOW_H
@@ -0,0 +1,89 @@
+#include "ReviewSession.h"
+#include "AlphabetQuizEngine.h"
+#include "Romanizer.h"
+
+ReviewDecks::ReviewDecks(std::shared_ptr<const DeckStore> store, bool complete)
+    : decks(std::move(store)), complete(complete) {
+    // One key buffer for the whole pass; only the hashes are kept
+    QString key;
+    wordsByKeyHash.reserve(decks->wordCount());
+    for (WordId id = 0; id < WordId(decks->wordCount()); ++id) {
+        SrsScheduler::writeWordKey(decks->word(id), key);
+        wordsByKeyHash.insert(qHash(key), id);
+    }
+}
+
+bool ReviewDecks::find(const QString &key, WordId &word) const {
+    const std::size_t hash = qHash(key);
+    QString candidate;
+    for (auto it = wordsByKeyHash.constFind(hash); it != wordsByKeyHash.cend() && it.key() == hash; ++it) {
+        SrsScheduler::writeWordKey(decks->word(it.value()), candidate);
+        if (candidate == key) {
+            word = it.value();
+            return true;
+        }
+    }
+    return false;
+}
+
+ReviewSession::ReviewSession(SrsScheduler &srs, const ReviewDecks *decks, const std::vector<QString> &keys)
+    : srs(srs), store(decks ? &decks->store() : nullptr) {
+    items.reserve(keys.size());
+    for (const QString &key : keys) {
+        Item item;
+        item.key = key;
+        if (SrsScheduler::isWordKey(key)) {
+            if (!decks || !decks->find(key, item.word)) {
+                // Words whose deck entry was edited or deleted are forgotten; a
+                // partly loaded store cannot tell those from words it has not read
+                if (decks && decks->isComplete()) srs.remove(key);
+                continue;
+            }
+        } else {
+            item.kana = SrsScheduler::kanaFromKey(key);
+            if (item.kana == AlphabetData::InvalidChar) {
+                srs.remove(key);
+                continue;
+            }
+            item.reading = AlphabetQuizEngine::reading(item.kana);
+        }
+        items.push_back(item);
+    }
+}
+
+QString ReviewSession::prompt() const {
+    if (finished()) return QString();
+    const Item &item = items[index];
+    if (item.kana != AlphabetData::InvalidChar) return AlphabetData::kanaText(item.kana);
+    return store->word(item.word).displayText().toString();
+}
+
+QString ReviewSession::romaji() const {
+    if (finished()) return QString();
+    const Item &item = items[index];
+    if (item.kana != AlphabetData::InvalidChar) return AlphabetData::romajiText(item.kana);
+    return store->word(item.word).romaji().toString();
+}
+
+bool ReviewSession::answer(QStringView input, std::int64_t now) {
+    if (finished() || input.trimmed().isEmpty()) return false;
+    const Item &item = items[index];
+    bool right = item.kana != AlphabetData::InvalidChar
+                     ? Romanizer::accepts(item.reading, input)
+                     : store->answers().matches(item.word, AnswerMatcher::Romaji, input);
+    srs.review(item.key, right ? SrsScheduler::Grade::Good : SrsScheduler::Grade::Again, now);
+    if (right) correct++;
+    else incorrect++;
+    return right;
+}
+
+AnswerTrie::Progress ReviewSession::liveProgress(QStringView input) const {
+    if (finished()) return AnswerTrie::Progress::Mismatch;
+    const Item &item = items[index];
+    if (item.kana != AlphabetData::InvalidChar) return Romanizer::progress(item.reading, input);
+    return store->answers().progress(item.word, AnswerMatcher::Romaji, input);
+}
+
+void ReviewSession::advance() {
+    if (!finished()) ++index;
+}
@@ -0,0 +1,73 @@
+#ifndef REVIEWSESSION_H
+#define REVIEWSESSION_H
+#include <QMultiHash>
+#include <QString>
+#include <QStringView>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "AnswerTrie.h"
+#include "DeckStore.h"
+#include "SrsScheduler.h"
+
+// The loaded decks as reviews see them: word cards are found through a
+// hash of their key, indexed once per deck load rather than per review.
+class ReviewDecks {
+public:
+    // `complete` is false after a cancelled or failed load; a word missing
+    // from such a store may still be in the vocabulary file.
+    ReviewDecks(std::shared_ptr<const DeckStore> store, bool complete);
+
+    const DeckStore &store() const { return *decks; }
+    bool isComplete() const { return complete; }
+    // The word a wordKey() names; false if it is not loaded.
+    bool find(const QString &key, WordId &word) const;
+
+private:
+    std::shared_ptr<const DeckStore> decks;
+    QMultiHash<std::size_t, WordId> wordsByKeyHash; // colliding keys are told apart in find()
+    bool complete;
+};
+
+// One pass over the cards that are due, kana and vocabulary words mixed.
+// Every prompt is answered in romaji: a kana's reading, or a word's romaji
+// as the vocabulary quiz accepts it. Each answer is graded into the
+// scheduler at once, so a session cut short keeps what was reviewed.
+class ReviewSession {
+public:
+    // `srs` and `decks` must outlive the session; `decks` may be null when
+    // no word cards are due. Keys that no longer name a kana are dropped
+    // from the schedule; so are words missing from `decks`, but only if it
+    // is complete. Otherwise they are skipped and kept for a later review.
+    ReviewSession(SrsScheduler &srs, const ReviewDecks *decks, const std::vector<QString> &keys);
+
+    bool finished() const { return index >= items.size(); }
+    int currentIndex() const { return static_cast<int>(index); }
+    int itemCount() const { return static_cast<int>(items.size()); }
+    // The kana or word to read, and its romaji for feedback after a miss.
+    QString prompt() const;
+    QString romaji() const;
+    // Checks and grades the current card (Good or Again). Does not advance.
+    bool answer(QStringView input, std::int64_t now);
+    AnswerTrie::Progress liveProgress(QStringView input) const;
+    void advance();
+    int correctCount() const { return correct; }
+    int incorrectCount() const { return incorrect; }
+
+private:
+    struct Item {
+        QString key;
+        AlphabetData::CharId kana = AlphabetData::InvalidChar;
+        WordId word = 0;
+        QString reading; // kana items: the kana spelled by the answer
+    };
+
+    SrsScheduler &srs;
+    const DeckStore *store = nullptr;
+    std::vector<Item> items;
+    std::size_t index = 0;
+    int correct = 0;
+    int incorrect = 0;
+};
+
+#endif // REVIEWSESSION_H
@@ -0,0 +1,114 @@
+#include "ReviewWindow.h"
+#include <QDateTime>
+#include <QFont>
+#include <QFontMetrics>
+#include <QIcon>
+#include <QMessageBox>
+#include <QTimer>
+#include <QVBoxLayout>
+
+ReviewWindow::ReviewWindow(SrsScheduler &srs, const ReviewDecks *decks, const std::vector<QString> &keys, QWidget *parent)
+    : QWidget(parent), session(srs, decks, keys) {
+    setWindowTitle("Review Due");
+    setGeometry(200, 200, 500, 300);
+#ifdef Q_OS_WIN
+    setWindowIcon(QIcon(":/appicon.ico"));
+#else
+    setWindowIcon(QIcon(":/appicon.png"));
+#endif
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    progressLabel = new QLabel(this);
+    progressLabel->setAlignment(Qt::AlignCenter);
+    progressLabel->setStyleSheet("font-size: 12px; color: #7f8c8d; padding: 5px;");
+    mainLayout->addWidget(progressLabel);
+
+    promptLabel = new QLabel(this);
+    QFont promptFont;
+    promptFont.setPointSize(40);
+    promptLabel->setFont(promptFont);
+    promptLabel->setAlignment(Qt::AlignCenter);
+    mainLayout->addWidget(promptLabel);
+
+    feedbackLabel = new QLabel(this);
+    feedbackLabel->setAlignment(Qt::AlignCenter);
+    feedbackLabel->setMinimumHeight(QFontMetrics(feedbackLabel->font()).height() + 6);
+    mainLayout->addWidget(feedbackLabel);
+
+    input = new QLineEdit(this);
+    input->setPlaceholderText("Enter Romaji...");
+    mainLayout->addWidget(input);
+    mainLayout->addStretch();
+
+    connect(input, &QLineEdit::returnPressed, this, &ReviewWindow::checkAnswer);
+    connect(input, &QLineEdit::textEdited, this, &ReviewWindow::onAnswerEdited);
+
+    // Show once the window is up, so an empty session can close itself
+    QTimer::singleShot(0, this, &ReviewWindow::showCard);
+}
+
+void ReviewWindow::showCard() {
+    waiting = false;
+    if (session.finished()) {
+        finish();
+        return;
+    }
+    progressLabel->setText(QString("Card %1/%2 | Correct: %3, Incorrect: %4")
+                               .arg(session.currentIndex() + 1)
+                               .arg(session.itemCount())
+                               .arg(session.correctCount())
+                               .arg(session.incorrectCount()));
+    promptLabel->setText(session.prompt());
+    feedbackLabel->clear();
+    input->clear();
+    setInputBorder("");
+    input->setFocus();
+}
+
+void ReviewWindow::checkAnswer() {
+    if (waiting || session.finished()) return;
+    if (session.answer(input->text(), QDateTime::currentSecsSinceEpoch())) {
+        session.advance();
+        showCard();
+        return;
+    }
+    // Leave the answer up for a moment before moving on
+    waiting = true;
+    feedbackLabel->setStyleSheet("color: red;");
+    feedbackLabel->setText(QString("Incorrect! %1 = %2").arg(session.prompt(), session.romaji()));
+    session.advance();
+    QTimer::singleShot(1200, this, &ReviewWindow::showCard);
+}
+
+void ReviewWindow::onAnswerEdited(const QString &text) {
+    if (waiting) return;
+    switch (session.liveProgress(text)) {
+    case AnswerTrie::Progress::Mismatch:
+        setInputBorder("#e74c3c");
+        break;
+    case AnswerTrie::Progress::Prefix:
+        setInputBorder("");
+        break;
+    case AnswerTrie::Progress::Complete:
+    case AnswerTrie::Progress::UniqueComplete:
+        setInputBorder("#27ae60");
+        break;
+    }
+}
+
+void ReviewWindow::setInputBorder(const QString &color) {
+    if (color == inputBorderColor) return; // restyling is the costly part
+    inputBorderColor = color;
+    input->setStyleSheet(color.isEmpty() ? QString() : QString("border: 2px solid %1;").arg(color));
+}
+
+void ReviewWindow::finish() {
+    QString msg = session.itemCount() == 0
+                      ? QString("Nothing is due for review.")
+                      : QString("Review complete!\n\nCorrect: %1\nIncorrect: %2\n\nMissed cards come back in a few minutes; the rest when they are due again.")
+                            .arg(session.correctCount())
+                            .arg(session.incorrectCount());
+    QMessageBox::information(this, "Review Summary", msg);
+    close();
+}
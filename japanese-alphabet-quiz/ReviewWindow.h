@@ -0,0 +1,33 @@
+#ifndef REVIEWWINDOW_H
+#define REVIEWWINDOW_H
+
+#include <QLabel>
+#include <QLineEdit>
+#include <QWidget>
+#include "ReviewSession.h"
+
+// Shows the cards a ReviewSession holds one by one and takes romaji
+// answers. Closes with a summary once every card has been answered.
+class ReviewWindow : public QWidget {
+    Q_OBJECT
+public:
+    // `decks` may be null when only kana are due; see ReviewSession.
+    ReviewWindow(SrsScheduler &srs, const ReviewDecks *decks, const std::vector<QString> &keys, QWidget *parent = nullptr);
+
+private:
+    void showCard();
+    void checkAnswer();
+    void onAnswerEdited(const QString &text);
+    void setInputBorder(const QString &color);
+    void finish();
+
+    ReviewSession session;
+    QLabel *progressLabel;
+    QLabel *promptLabel;
+    QLabel *feedbackLabel;
+    QLineEdit *input;
+    QString inputBorderColor;
+    bool waiting = false; // showing the answer to a miss
+};
+
+#endif // REVIEWWINDOW_H
@@ -0,0 +1,530 @@
+#include "Romanizer.h"
+#include "AnswerMatcher.h"
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+using Progress = AnswerTrie::Progress;
+
+// Every kana unit with its spellings, Hepburn first; '*' marks a particle
+// reading. ん, ー and sokuon doubling are rules in the code below.
+struct UnitSpec {
+    const char16_t *kana;
+    const char *romaji;
+};
+
+const UnitSpec Units[] = {
+    {u"あ", "a"}, {u"い", "i"}, {u"う", "u"}, {u"え", "e"}, {u"お", "o"},
+    {u"か", "ka"}, {u"き", "ki"}, {u"く", "ku"}, {u"け", "ke"}, {u"こ", "ko"},
+    {u"さ", "sa"}, {u"し", "shi si"}, {u"す", "su"}, {u"せ", "se"}, {u"そ", "so"},
+    {u"た", "ta"}, {u"ち", "chi ti"}, {u"つ", "tsu tu"}, {u"て", "te"}, {u"と", "to"},
+    {u"な", "na"}, {u"に", "ni"}, {u"ぬ", "nu"}, {u"ね", "ne"}, {u"の", "no"},
+    {u"は", "ha *wa"}, {u"ひ", "hi"}, {u"ふ", "fu hu"}, {u"へ", "he *e"}, {u"ほ", "ho"},
+    {u"ま", "ma"}, {u"み", "mi"}, {u"む", "mu"}, {u"め", "me"}, {u"も", "mo"},
+    {u"や", "ya"}, {u"ゆ", "yu"}, {u"よ", "yo"},
+    {u"ら", "ra"}, {u"り", "ri"}, {u"る", "ru"}, {u"れ", "re"}, {u"ろ", "ro"},
+    {u"わ", "wa"}, {u"ゐ", "wi i"}, {u"ゑ", "we e"}, {u"を", "wo o"},
+    {u"が", "ga"}, {u"ぎ", "gi"}, {u"ぐ", "gu"}, {u"げ", "ge"}, {u"ご", "go"},
+    {u"ざ", "za"}, {u"じ", "ji zi"}, {u"ず", "zu"}, {u"ぜ", "ze"}, {u"ぞ", "zo"},
+    {u"だ", "da"}, {u"ぢ", "ji di zi"}, {u"づ", "zu du"}, {u"で", "de"}, {u"ど", "do"},
+    {u"ば", "ba"}, {u"び", "bi"}, {u"ぶ", "bu"}, {u"べ", "be"}, {u"ぼ", "bo"},
+    {u"ぱ", "pa"}, {u"ぴ", "pi"}, {u"ぷ", "pu"}, {u"ぺ", "pe"}, {u"ぽ", "po"},
+    {u"ゔ", "vu"},
+    // Yōon
+    {u"きゃ", "kya"}, {u"きゅ", "kyu"}, {u"きょ", "kyo"},
+    {u"しゃ", "sha sya"}, {u"しゅ", "shu syu"}, {u"しょ", "sho syo"}, {u"しぇ", "she sye"},
+    {u"ちゃ", "cha tya cya"}, {u"ちゅ", "chu tyu cyu"}, {u"ちょ", "cho tyo cyo"}, {u"ちぇ", "che tye cye"},
+    {u"にゃ", "nya"}, {u"にゅ", "nyu"}, {u"にょ", "nyo"},
+    {u"ひゃ", "hya"}, {u"ひゅ", "hyu"}, {u"ひょ", "hyo"},
+    {u"みゃ", "mya"}, {u"みゅ", "myu"}, {u"みょ", "myo"},
+    {u"りゃ", "rya"}, {u"りゅ", "ryu"}, {u"りょ", "ryo"},
+    {u"ぎゃ", "gya"}, {u"ぎゅ", "gyu"}, {u"ぎょ", "gyo"},
+    {u"じゃ", "ja zya jya"}, {u"じゅ", "ju zyu jyu"}, {u"じょ", "jo zyo jyo"}, {u"じぇ", "je zye jye"},
+    {u"ぢゃ", "ja zya dya"}, {u"ぢゅ", "ju zyu dyu"}, {u"ぢょ", "jo zyo dyo"},
+    {u"びゃ", "bya"}, {u"びゅ", "byu"}, {u"びょ", "byo"},
+    {u"ぴゃ", "pya"}, {u"ぴゅ", "pyu"}, {u"ぴょ", "pyo"},
+    // Extended katakana, folded to hiragana like everything else
+    {u"ふぁ", "fa"}, {u"ふぃ", "fi"}, {u"ふぇ", "fe"}, {u"ふぉ", "fo"}, {u"ふゅ", "fyu"},
+    {u"ゔぁ", "va"}, {u"ゔぃ", "vi"}, {u"ゔぇ", "ve"}, {u"ゔぉ", "vo"}, {u"ゔゅ", "vyu"},
+    {u"うぃ", "wi"}, {u"うぇ", "we"}, {u"うぉ", "wo"}, {u"いぇ", "ye"},
+    {u"てぃ", "ti thi"}, {u"てゅ", "tyu thu"}, {u"でぃ", "di dhi"}, {u"でゅ", "dyu dhu"},
+    {u"とぅ", "tu twu"}, {u"どぅ", "du dwu"},
+    {u"つぁ", "tsa"}, {u"つぃ", "tsi"}, {u"つぇ", "tse"}, {u"つぉ", "tso"},
+    {u"くぁ", "kwa"}, {u"ぐぁ", "gwa"},
+    // Small kana on their own
+    {u"ぁ", "xa la"}, {u"ぃ", "xi li"}, {u"ぅ", "xu lu"}, {u"ぇ", "xe le"}, {u"ぉ", "xo lo"},
+    {u"ゃ", "xya lya"}, {u"ゅ", "xyu lyu"}, {u"ょ", "xyo lyo"}, {u"ゎ", "xwa lwa"},
+    {u"っ", "xtsu xtu ltsu ltu"}, {u"ゕ", "xka"}, {u"ゖ", "xke"},
+};
+
+constexpr char16_t Sokuon = u'っ';
+constexpr char16_t Hatsuon = u'ん';
+constexpr char16_t LongMark = u'ー';
+constexpr char16_t Vowels[] = u"aiueo";
+constexpr char16_t Macrons[] = u"āīūēō";
+constexpr char16_t Circumflexes[] = u"âîûêô";
+constexpr int VowelU = 2, VowelE = 3, VowelO = 4;
+
+// A trie flattened into arrays. The arcs of a node are one sorted run, so
+// each step is a binary search over a handful of labels.
+class FlatTrie {
+public:
+    using Key = std::pair<std::u16string, std::uint16_t>;
+
+    // Keys that share a spelling keep their order, so the first value of a
+    // node is the preferred one.
+    void build(std::vector<Key> keys) {
+        std::stable_sort(keys.begin(), keys.end(), [](const Key &a, const Key &b) { return a.first < b.first; });
+        addNode(keys, 0, keys.size(), 0);
+        nodes.shrink_to_fit();
+        labels.shrink_to_fit();
+        targets.shrink_to_fit();
+        values.shrink_to_fit();
+    }
+    // The node reached from `node` by `c`, or -1; the root is node 0.
+    int child(int node, char16_t c) const {
+        const Node &n = nodes[std::size_t(node)];
+        auto first = labels.begin() + n.firstArc, last = first + n.arcCount;
+        auto it = std::lower_bound(first, last, c);
+        return it != last && *it == c ? int(targets[std::size_t(it - labels.begin())]) : -1;
+    }
+    bool hasChildren(int node) const { return nodes[std::size_t(node)].arcCount != 0; }
+    int valueCount(int node) const { return nodes[std::size_t(node)].valueCount; }
+    int value(int node, int i) const { return values[nodes[std::size_t(node)].firstValue + std::size_t(i)]; }
+
+private:
+    struct Node {
+        std::uint32_t firstArc = 0;
+        std::uint16_t arcCount = 0;
+        std::uint16_t firstValue = 0;
+        std::uint16_t valueCount = 0;
+    };
+
+    std::uint32_t addNode(const std::vector<Key> &keys, std::size_t lo, std::size_t hi, std::size_t depth) {
+        const std::size_t id = nodes.size();
+        nodes.emplace_back();
+        nodes[id].firstValue = std::uint16_t(values.size());
+        for (; lo < hi && keys[lo].first.size() == depth; ++lo) values.push_back(keys[lo].second);
+        nodes[id].valueCount = std::uint16_t(values.size() - nodes[id].firstValue);
+        // Reserve this node's run of arcs before the children add theirs
+        std::vector<std::pair<std::size_t, std::size_t>> groups;
+        for (std::size_t i = lo; i < hi;) {
+            std::size_t j = i;
+            while (j < hi && keys[j].first[depth] == keys[i].first[depth]) ++j;
+            groups.push_back({i, j});
+            i = j;
+        }
+        const std::size_t firstArc = labels.size();
+        nodes[id].firstArc = std::uint32_t(firstArc);
+        nodes[id].arcCount = std::uint16_t(groups.size());
+        labels.resize(firstArc + groups.size());
+        targets.resize(labels.size());
+        for (std::size_t g = 0; g < groups.size(); ++g) {
+            labels[firstArc + g] = keys[groups[g].first].first[depth];
+            std::uint32_t target = addNode(keys, groups[g].first, groups[g].second, depth + 1);
+            targets[firstArc + g] = target;
+        }
+        return std::uint32_t(id);
+    }
+
+    std::vector<Node> nodes;
+    std::vector<char16_t> labels;
+    std::vector<std::uint32_t> targets;
+    std::vector<std::uint16_t> values;
+};
+
+struct Spelling {
+    std::uint16_t offset;
+    std::uint8_t length;
+    bool particle;
+};
+
+struct Unit {
+    std::uint16_t kanaOffset;
+    std::uint8_t kanaLength;
+    std::uint8_t spellingCount;
+    std::uint16_t firstSpelling;
+};
+
+// Units compiled into the two tries. Built once, on first use.
+class Tables {
+public:
+    Tables() {
+        std::vector<FlatTrie::Key> kanaKeys, romajiKeys;
+        for (const UnitSpec &spec : Units) {
+            const auto id = std::uint16_t(units.size());
+            const std::u16string kana(spec.kana);
+            Unit unit{std::uint16_t(text.size()), std::uint8_t(kana.size()), 0, std::uint16_t(spellings.size())};
+            text.insert(text.end(), kana.begin(), kana.end());
+            kanaKeys.push_back({kana, id});
+            for (const char *s = spec.romaji; *s;) {
+                const bool particle = *s == '*';
+                if (particle) ++s;
+                const char *end = s;
+                while (*end && *end != ' ') ++end;
+                const std::u16string romaji(s, end);
+                spellings.push_back({std::uint16_t(text.size()), std::uint8_t(romaji.size()), particle});
+                text.insert(text.end(), romaji.begin(), romaji.end());
+                // Particle readings are never typed to get that kana
+                if (!particle) romajiKeys.push_back({romaji, id});
+                ++unit.spellingCount;
+                s = *end ? end + 1 : end;
+            }
+            units.push_back(unit);
+        }
+        // Shared spellings keep table order, so plain kana win as an IME
+        // would have it: "ji" writes じ before ぢ, "ti" ち before てぃ
+        kanaTrie.build(std::move(kanaKeys));
+        romajiTrie.build(std::move(romajiKeys));
+        text.shrink_to_fit();
+    }
+
+    QStringView kana(int unit) const {
+        const Unit &u = units[std::size_t(unit)];
+        return QStringView(text.data() + u.kanaOffset, u.kanaLength);
+    }
+    QStringView spelling(int index) const {
+        const Spelling &s = spellings[std::size_t(index)];
+        return QStringView(text.data() + s.offset, s.length);
+    }
+    QStringView hepburn(int unit) const { return spelling(units[std::size_t(unit)].firstSpelling); }
+
+    std::vector<char16_t> text; // kana and spellings of every unit
+    std::vector<Unit> units;
+    std::vector<Spelling> spellings;
+    FlatTrie kanaTrie;   // hiragana -> units
+    FlatTrie romajiTrie; // romaji -> units
+};
+
+const Tables &tables() {
+    static const Tables t;
+    return t;
+}
+
+// Katakana folds onto hiragana; spaces and punctuation fold to 0 and are skipped.
+char16_t foldKana(char16_t c) {
+    if (c >= u'ァ' && c <= u'ヶ') return char16_t(c - 0x60);
+    if (c == u' ' || c == u'　' || c == u'・' || c == u'〜' || c == u'～' || c == u'、' || c == u'。'
+        || c == u'！' || c == u'？')
+        return 0;
+    return c;
+}
+
+// Hyphens are kept: they either mark a long vowel (kādo as ka-do) or
+// separate words, and the transducer tries both.
+char16_t foldRomaji(char16_t c) {
+    if (c == u' ' || c == u',' || c == u'.' || c == u'!' || c == u'?') return 0;
+    if (c == u'‐') return u'-';
+    if (c == u'’') return u'\'';
+    return AnswerMatcher::fold(c);
+}
+
+int vowelOf(char16_t c) {
+    for (int v = 0; v < 5; ++v)
+        if (c == Vowels[v] || c == Macrons[v] || c == Circumflexes[v]) return v;
+    return -1;
+}
+
+bool isConsonant(char16_t c) {
+    return c >= u'a' && c <= u'z' && c != u'n' && vowelOf(c) < 0;
+}
+
+// Where Hepburn writes ん as n' (kin'en)
+bool startsWithVowelOrY(char16_t kana) {
+    return kana == u'あ' || kana == u'い' || kana == u'う' || kana == u'え' || kana == u'お'
+        || kana == u'や' || kana == u'ゆ' || kana == u'よ';
+}
+
+// ば, ぱ and ま rows, before which ん may be written m (shimbun)
+bool isLabial(char16_t kana) {
+    return (kana >= u'ば' && kana <= u'ぽ' && (kana - u'は') % 3 != 0) || (kana >= u'ま' && kana <= u'も');
+}
+
+// Whether kana `next` lengthens a syllable ending in `vowel`
+bool lengthens(int vowel, char16_t next) {
+    constexpr char16_t Same[] = u"あいうえお";
+    return next == LongMark || next == Same[vowel] || (vowel == VowelO && next == u'う') || (vowel == VowelE && next == u'い');
+}
+
+// Long o and u (and ー) are often not written at all: Tokyo, gyunyu, kohi
+bool mayDrop(int vowel, char16_t next) {
+    return next == LongMark || ((vowel == VowelU || vowel == VowelO) && lengthens(vowel, next));
+}
+
+// Runs the tables as a nondeterministic transducer over (kana position,
+// typed position) pairs. Each pair is visited at most once, so a check is
+// bounded by kana length * typed length and is usually close to linear.
+class Transducer {
+public:
+    Transducer(QStringView kanaText, QStringView romaji, unsigned options) : t(tables()), options(options) {
+        QVarLengthArray<bool, 32> wordStart;
+        bool atWordStart = true;
+        for (QChar c : kanaText) {
+            const char16_t f = foldKana(c.unicode());
+            if (!f) {
+                atWordStart = true;
+                continue;
+            }
+            kana.append(f);
+            wordStart.append(atWordStart);
+            atWordStart = false;
+        }
+        // A particle follows the word it marks, inside it or on its own
+        // (わたしは, わたし は), but never begins one (はな)
+        particle.resize(kana.size());
+        for (qsizetype k = 0; k < kana.size(); ++k)
+            particle[k] = k > 0 && (!wordStart[k] || k + 1 == kana.size() || wordStart[k + 1]);
+        for (QChar c : romaji)
+            if (char16_t f = foldRomaji(c.unicode())) typed.append(f);
+        seen.resize((kana.size() + 1) * (typed.size() + 1));
+        std::fill(seen.begin(), seen.end(), false);
+    }
+
+    Progress run(bool firstMatch) {
+        if (typed.isEmpty()) return Progress::Prefix;
+        const int width = int(typed.size()) + 1;
+        push(0, 0);
+        while (!pending.isEmpty() && !(firstMatch && complete)) {
+            const int state = pending.last();
+            pending.removeLast();
+            step(state / width, state % width);
+        }
+        if (complete) return extendable ? Progress::Complete : Progress::UniqueComplete;
+        return extendable ? Progress::Prefix : Progress::Mismatch;
+    }
+
+private:
+    void push(int k, int p) {
+        const int state = k * (int(typed.size()) + 1) + p;
+        if (seen[state]) return;
+        seen[state] = true;
+        pending.append(state);
+    }
+
+    // 1 if the typed text at p starts with s, 0 if it ends inside s, -1 if it differs
+    int follow(int p, QStringView s) const {
+        for (qsizetype i = 0; i < s.size(); ++i, ++p) {
+            if (p == typed.size()) return 0;
+            if (typed[p] != s[i].unicode()) return -1;
+        }
+        return 1;
+    }
+
+    void step(int k, int p) {
+        const int kanaEnd = int(kana.size()), typedEnd = int(typed.size());
+        if (p < typedEnd && typed[p] == u'-') push(k, p + 1);
+        if (k == kanaEnd) {
+            if (p == typedEnd) complete = true;
+            return;
+        }
+        if (p == typedEnd) extendable = true;
+        const char16_t c = kana[k];
+        const char16_t next = k + 1 < kanaEnd ? kana[k + 1] : 0;
+        if (c == LongMark) {
+            // Repeats the vowel before it, or is left out (kaado, ka-do, kado)
+            const int v = p > 0 ? vowelOf(typed[p - 1]) : -1;
+            if (v >= 0 && p < typedEnd && typed[p] == Vowels[v]) push(k + 1, p + 1);
+            push(k + 1, p);
+            return;
+        }
+        if (c == Hatsuon) {
+            // n, n' or nn, and m before b, m and p. Hepburn wants n' before a
+            // vowel or y (kin'en), but the kana being known, kinen is no less clear.
+            if (p < typedEnd && typed[p] == u'n') {
+                push(k + 1, p + 1);
+                if (p + 1 == typedEnd) extendable = true;
+                else if (typed[p + 1] == u'\'' || typed[p + 1] == u'n') push(k + 1, p + 2);
+            }
+            if (p < typedEnd && typed[p] == u'm' && isLabial(next)) push(k + 1, p + 1);
+            return;
+        }
+        if (c == Sokuon && next && p < typedEnd && isConsonant(typed[p])) {
+            // Doubles the next consonant, with tch for ch
+            if (p + 1 == typedEnd) extendable = true;
+            else if (typed[p + 1] == typed[p] || (typed[p] == u't' && typed[p + 1] == u'c')) push(k + 1, p + 1);
+        }
+        // A final っ (えっ) has no sound to double
+        if (c == Sokuon && !next) push(k + 1, p);
+        bool known = false;
+        int node = 0;
+        for (int j = k; j < kanaEnd && (node = t.kanaTrie.child(node, kana[j])) >= 0; ++j) {
+            known = true;
+            for (int i = 0; i < t.kanaTrie.valueCount(node); ++i) spell(j + 1, p, t.kanaTrie.value(node, i));
+        }
+        // Anything else in the kana (digits, Latin letters) is typed as is
+        if (!known && p < typedEnd && typed[p] == AnswerMatcher::fold(c)) push(k + 1, p + 1);
+    }
+
+    // Tries every spelling of `unit`, a unit of kana that ends before `end`
+    void spell(int end, int p, int unitIndex) {
+        const Unit &unit = t.units[std::size_t(unitIndex)];
+        const int typedEnd = int(typed.size());
+        const char16_t next = end < int(kana.size()) ? kana[end] : 0;
+        const bool particles = (options & Romanizer::ParticleReadings) && particle[end - unit.kanaLength];
+        for (int i = unit.firstSpelling; i < unit.firstSpelling + unit.spellingCount; ++i) {
+            if (t.spellings[std::size_t(i)].particle && !particles) continue;
+            const QStringView s = t.spelling(i);
+            const int q = p + int(s.size());
+            const int vowel = vowelOf(s.back().unicode());
+            const bool longVowel = vowel >= 0 && next && lengthens(vowel, next);
+            switch (follow(p, s)) {
+            case 1:
+                push(end, q);
+                if (longVowel && mayDrop(vowel, next)) push(end + 1, q);
+                if (longVowel && q < typedEnd) {
+                    // A hyphen for any long vowel; oo for ou, ee for ei and passport-style oh
+                    if (typed[q] == u'-') push(end + 1, q + 1);
+                    else if (next != LongMark && (typed[q] == Vowels[vowel] || (vowel == VowelO && typed[q] == u'h')))
+                        push(end + 1, q + 1);
+                }
+                break;
+            case 0:
+                extendable = true;
+                break;
+            default:
+                // ō or ô spells the vowel and the kana that lengthens it
+                if (longVowel && q <= typedEnd && (typed[q - 1] == Macrons[vowel] || typed[q - 1] == Circumflexes[vowel])
+                    && follow(p, s.chopped(1)) == 1)
+                    push(end + 1, q);
+                break;
+            }
+        }
+    }
+
+    const Tables &t;
+    const unsigned options;
+    QVarLengthArray<char16_t, 32> kana;
+    QVarLengthArray<bool, 32> particle; // per kana: where a particle may stand
+    QVarLengthArray<char16_t, 64> typed;
+    QVarLengthArray<bool, 1024> seen;
+    QVarLengthArray<int, 64> pending;
+    bool complete = false;
+    bool extendable = false;
+};
+}
+
+bool Romanizer::accepts(QStringView kana, QStringView romaji, unsigned options) {
+    Progress progress = Transducer(kana, romaji, options).run(true);
+    return progress == Progress::Complete || progress == Progress::UniqueComplete;
+}
+
+AnswerTrie::Progress Romanizer::progress(QStringView kana, QStringView romaji, unsigned options) {
+    return Transducer(kana, romaji, options).run(false);
+}
+
+QString Romanizer::toRomaji(QStringView kanaText) {
+    const Tables &t = tables();
+    QVarLengthArray<char16_t, 32> kana;
+    for (QChar c : kanaText)
+        if (char16_t f = foldKana(c.unicode())) kana.append(f);
+    QString out;
+    bool sokuon = false;
+    for (int k = 0; k < kana.size();) {
+        const char16_t c = kana[k];
+        if (c == LongMark) {
+            const int v = out.isEmpty() ? -1 : vowelOf(out.back().unicode());
+            if (v >= 0) out += QChar(Vowels[v]);
+            ++k;
+            continue;
+        }
+        if (c == Sokuon && k + 1 < kana.size()) {
+            sokuon = true;
+            ++k;
+            continue;
+        }
+        if (c == Hatsuon) {
+            out += QChar(u'n');
+            if (k + 1 < kana.size() && startsWithVowelOrY(kana[k + 1])) out += QChar(u'\'');
+            ++k;
+            continue;
+        }
+        int node = 0, unit = -1, end = k + 1;
+        for (int j = k; j < kana.size() && (node = t.kanaTrie.child(node, kana[j])) >= 0; ++j) {
+            if (t.kanaTrie.valueCount(node) == 0) continue;
+            unit = t.kanaTrie.value(node, 0);
+            end = j + 1;
+        }
+        const QStringView spelled = unit >= 0 ? t.hepburn(unit) : QStringView(&kana[k], 1);
+        if (sokuon) {
+            if (isConsonant(spelled.front().unicode())) out += spelled.startsWith(u"ch") ? QChar(u't') : spelled.front();
+            else out += QStringLiteral("xtsu");
+            sokuon = false;
+        }
+        out += spelled;
+        k = end;
+    }
+    return out;
+}
+
+Romanizer::Match Romanizer::longestSpelling(QStringView romaji) {
+    const Tables &t = tables();
+    Match match;
+    int node = 0;
+    for (int j = 0; j < romaji.size(); ++j) {
+        node = t.romajiTrie.child(node, AnswerMatcher::fold(romaji[j].unicode()));
+        if (node < 0) return match;
+        if (t.romajiTrie.valueCount(node) == 0) continue;
+        match.length = j + 1;
+        match.kana = t.kana(t.romajiTrie.value(node, 0));
+    }
+    match.open = t.romajiTrie.hasChildren(node);
+    return match;
+}
+
+QString Romanizer::toKana(QStringView romajiText, bool katakana) {
+    const Tables &t = tables();
+    // Long vowels are spelled out first: ō as ou, or as o- for katakana
+    constexpr char16_t Lengthening[] = u"aiuiu";
+    QVarLengthArray<char16_t, 64> r;
+    for (QChar ch : romajiText) {
+        const char16_t c = AnswerMatcher::fold(ch.unicode());
+        const int v = vowelOf(c);
+        if (v >= 0 && c != Vowels[v]) {
+            r.append(Vowels[v]);
+            r.append(katakana ? u'-' : Lengthening[v]);
+        } else {
+            r.append(c == u'’' ? u'\'' : c);
+        }
+    }
+    auto vowelOrY = [&r](int i) { return i < r.size() && (vowelOf(r[i]) >= 0 || r[i] == u'y'); };
+    QString out;
+    for (int i = 0; i < r.size();) {
+        const char16_t c = r[i];
+        const char16_t next = i + 1 < r.size() ? r[i + 1] : 0;
+        if (c == u'n' && !vowelOrY(i + 1)) {
+            // n' and a final nn are one ん; in "konnichiwa" the second n starts ni
+            const bool pair = next == u'\'' || (next == u'n' && !vowelOrY(i + 2));
+            out += QChar(Hatsuon);
+            i += pair ? 2 : 1;
+            continue;
+        }
+        if (isConsonant(c) && (next == c || (c == u't' && next == u'c'))) {
+            out += QChar(Sokuon);
+            ++i;
+            continue;
+        }
+        if (c == u'-') {
+            out += QChar(LongMark);
+            ++i;
+            continue;
+        }
+        int node = 0, unit = -1, end = i + 1;
+        for (int j = i; j < r.size() && (node = t.romajiTrie.child(node, r[j])) >= 0; ++j) {
+            if (t.romajiTrie.valueCount(node) == 0) continue;
+            unit = t.romajiTrie.value(node, 0);
+            end = j + 1;
+        }
+        if (unit >= 0) out += t.kana(unit);
+        else out += QChar(c);
+        i = end;
+    }
+    if (katakana) {
+        for (QChar &c : out)
+            if (c.unicode() >= u'ぁ' && c.unicode() <= u'ゖ') c = QChar(char16_t(c.unicode() + 0x60));
+    }
+    return out;
+}
@@ -0,0 +1,47 @@
+#ifndef ROMANIZER_H
+#define ROMANIZER_H
+#include <QString>
+#include <QStringView>
+#include "AnswerTrie.h"
+
+// Kana <-> romaji transliteration. One table lists every kana unit (single
+// kana, yōon and extended-katakana digraphs) with its Hepburn spelling
+// first, then Kunrei, Nihon-shiki and common typing variants. On first use
+// it is compiled into two flat tries: kana -> units for reading, and
+// romaji -> units for writing kana. Sokuon, ん and long vowels (ou, oo, ō,
+// ô, oh, ー or left out) are rules on top of the tables rather than rows.
+//
+// A typed answer is checked by running the tables as a transducer over
+// (kana position, typed position) pairs, so the spellings of a word are
+// never listed out, and a word with many variants costs no more than one
+// with a few.
+class Romanizer {
+public:
+    enum Option : unsigned {
+        None = 0,
+        // は = wa, へ = e, as in こんにちは. Never for the kana a word
+        // begins with, so はな is not "wana".
+        ParticleReadings = 1,
+    };
+
+    // True if `romaji` spells `kana` (hiragana or katakana) in any supported
+    // system. Case, spaces and hyphens are ignored.
+    static bool accepts(QStringView kana, QStringView romaji, unsigned options = None);
+    // How far `romaji` is along some spelling of `kana`, for live feedback.
+    static AnswerTrie::Progress progress(QStringView kana, QStringView romaji, unsigned options = None);
+    // The Hepburn spelling, with long vowels written out (kaado, toukyou).
+    static QString toRomaji(QStringView kana);
+    // The longest spelling at the start of `romaji`, for converting text
+    // while it is typed.
+    struct Match {
+        int length = 0;    // letters it takes up; 0 if no spelling fits
+        QStringView kana;  // its hiragana
+        bool open = false; // all of `romaji` begins some longer spelling
+    };
+    static Match longestSpelling(QStringView romaji);
+    // Longest-match conversion of finished romaji; letters that spell no
+    // kana are kept as they are.
+    static QString toKana(QStringView romaji, bool katakana = false);
+};
+
+#endif // ROMANIZER_H
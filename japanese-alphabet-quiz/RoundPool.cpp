@@ -0,0 +1,37 @@
+#include "RoundPool.h"
+
+RoundPool::RoundPool(std::size_t itemCount) {
+    reset(itemCount);
+}
+
+void RoundPool::reset(std::size_t itemCount) {
+    counts.assign(itemCount, 0);
+    multipliers.assign(itemCount, 1);
+    total = 0;
+    sampler.reset(itemCount);
+}
+
+void RoundPool::setCount(std::size_t item, int count) {
+    total = total - counts[item] + count;
+    counts[item] = count;
+    sampler.setWeight(item, weightFor(item, count));
+}
+
+void RoundPool::setMultiplier(std::size_t item, std::uint64_t multiplier) {
+    multipliers[item] = multiplier;
+    sampler.setWeight(item, weightFor(item, counts[item]));
+}
+
+void RoundPool::setMultipliers(const std::vector<std::uint64_t> &newMultipliers) {
+    multipliers = newMultipliers;
+    std::vector<std::uint64_t> weights(counts.size());
+    for (std::size_t i = 0; i < counts.size(); ++i)
+        weights[i] = weightFor(i, counts[i]);
+    sampler.assign(weights);
+}
+
+bool RoundPool::take(std::size_t item) {
+    if (counts[item] == 0) return false;
+    setCount(item, counts[item] - 1);
+    return true;
+}
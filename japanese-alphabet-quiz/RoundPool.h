@@ -0,0 +1,47 @@
+#ifndef ROUNDPOOL_H
+#define ROUNDPOOL_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "WeightedSampler.h"
+
+// Remaining occurrences per item for one quiz round. Memory is O(items)
+// no matter how many times each item is repeated. Each item also carries
+// a per-occurrence multiplier so draws can be uniform (all 1) or weighted.
+class RoundPool {
+public:
+    explicit RoundPool(std::size_t itemCount = 0);
+    void reset(std::size_t itemCount);
+    void setCount(std::size_t item, int count);
+    void setMultiplier(std::size_t item, std::uint64_t multiplier);
+    void setMultipliers(const std::vector<std::uint64_t> &multipliers);
+    int remaining(std::size_t item) const { return counts[item]; }
+    std::uint64_t totalRemaining() const { return total; }
+    bool empty() const { return total == 0; }
+    // Removes one occurrence; returns false if none was left.
+    bool take(std::size_t item);
+
+    // Draws an occurrence; optionally one occurrence of `excludeOne` is left
+    // out of the draw (used to avoid asking the same item twice in a row).
+    template <typename Rng>
+    std::size_t draw(Rng &rng, std::size_t excludeOne = NoItem) {
+        bool exclude = excludeOne != NoItem && total > 1 && counts[excludeOne] > 0;
+        if (exclude) sampler.setWeight(excludeOne, weightFor(excludeOne, counts[excludeOne] - 1));
+        std::size_t item = sampler.sample(rng);
+        if (exclude) sampler.setWeight(excludeOne, weightFor(excludeOne, counts[excludeOne]));
+        return item;
+    }
+
+    static constexpr std::size_t NoItem = static_cast<std::size_t>(-1);
+
+private:
+    std::uint64_t weightFor(std::size_t item, int count) const {
+        return static_cast<std::uint64_t>(count) * multipliers[item];
+    }
+    std::vector<int> counts;
+    std::vector<std::uint64_t> multipliers;
+    std::uint64_t total = 0;
+    WeightedSampler sampler;
+};
+
+#endif // ROUNDPOOL_H
@@ -0,0 +1,43 @@
+#include "SessionRandom.h"
+
+namespace {
+struct State {
+    SessionRandom::Engine engine;
+    std::uint64_t seed = 0;
+    bool seeded = false;
+    bool fixed = false;
+};
+
+State &state() {
+    static State s;
+    return s;
+}
+}
+
+void SessionRandom::seedFixed(std::uint64_t seed) {
+    State &s = state();
+    s.seed = seed;
+    s.engine.seed(seed);
+    s.seeded = true;
+    s.fixed = true;
+}
+
+void SessionRandom::seedRandom() {
+    std::random_device rd;
+    seedFixed((static_cast<std::uint64_t>(rd()) << 32) | rd());
+    state().fixed = false;
+}
+
+std::uint64_t SessionRandom::seed() {
+    engine(); // seeds lazily if nobody has yet
+    return state().seed;
+}
+
+bool SessionRandom::isFixed() {
+    return state().fixed;
+}
+
+SessionRandom::Engine &SessionRandom::engine() {
+    if (!state().seeded) seedRandom();
+    return state().engine;
+}
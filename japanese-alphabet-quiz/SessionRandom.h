@@ -0,0 +1,19 @@
+#ifndef SESSIONRANDOM_H
+#define SESSIONRANDOM_H
+#include <cstdint>
+#include <random>
+
+// One random engine for the whole application session, seeded once.
+// Passing a fixed seed (--seed or the profile's "rng_seed") makes every
+// question order and shuffle reproducible.
+class SessionRandom {
+public:
+    using Engine = std::mt19937_64;
+    static void seedFixed(std::uint64_t seed);
+    static void seedRandom();
+    static std::uint64_t seed();
+    static bool isFixed();
+    static Engine &engine();
+};
+
+#endif // SESSIONRANDOM_H
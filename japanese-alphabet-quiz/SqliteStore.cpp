@@ -0,0 +1,242 @@
+#include "SqliteStore.h"
+#include "AlphabetQuizEngine.h"
+#include "ErrorStatsJournal.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSqlError>
+
+namespace {
+const char *const MigratedKey = "json_migrated";
+
+// Keyed lookups hit the primary keys; the time index serves
+// "hardest words since ..." without scanning older attempts.
+const char *const Schema[] = {
+    "CREATE TABLE IF NOT EXISTS meta ("
+    " key TEXT PRIMARY KEY, value TEXT) WITHOUT ROWID",
+    "CREATE TABLE IF NOT EXISTS char_stats ("
+    " profile TEXT NOT NULL, char_key TEXT NOT NULL, errors INTEGER NOT NULL,"
+    " PRIMARY KEY (profile, char_key)) WITHOUT ROWID",
+    "CREATE TABLE IF NOT EXISTS word_attempts ("
+    " id INTEGER PRIMARY KEY, profile TEXT NOT NULL, word_key TEXT NOT NULL,"
+    " attempted_at INTEGER NOT NULL, correct INTEGER NOT NULL)",
+    "CREATE INDEX IF NOT EXISTS word_attempts_by_time ON word_attempts (profile, attempted_at)",
+    "CREATE TABLE IF NOT EXISTS deck_scores ("
+    " profile TEXT NOT NULL, deck TEXT NOT NULL,"
+    " best_romaji REAL NOT NULL DEFAULT 0, best_english REAL NOT NULL DEFAULT 0,"
+    " PRIMARY KEY (profile, deck)) WITHOUT ROWID",
+};
+} // namespace
+
+SqliteStore::~SqliteStore() {
+    close();
+}
+
+QString SqliteStore::pathFor(const QString &profilesDir) {
+    return profilesDir + "/quiz.sqlite";
+}
+
+bool SqliteStore::open(const QString &databasePath, const QString &connectionName) {
+    close();
+    connection = connectionName;
+    db = QSqlDatabase::addDatabase("QSQLITE", connection);
+    db.setDatabaseName(databasePath);
+    if (!db.open()) {
+        lastError = db.lastError().text();
+        qDebug() << "Failed to open database:" << databasePath << lastError;
+        close();
+        return false;
+    }
+    // WAL lets the preloader read while the quiz writes; NORMAL only
+    // syncs at checkpoints, which is durable enough for practice stats.
+    if (!exec("PRAGMA journal_mode=WAL") || !exec("PRAGMA synchronous=NORMAL")
+        || !exec("PRAGMA busy_timeout=2000") || !createSchema()) {
+        close();
+        return false;
+    }
+
+    upsertCharErrors = QSqlQuery(db);
+    upsertCharErrors.prepare("INSERT INTO char_stats (profile, char_key, errors) VALUES (?, ?, ?)"
+                             " ON CONFLICT (profile, char_key) DO UPDATE SET errors = excluded.errors");
+    deleteCharErrors = QSqlQuery(db);
+    deleteCharErrors.prepare("DELETE FROM char_stats WHERE profile = ? AND char_key = ?");
+    insertAttempt = QSqlQuery(db);
+    insertAttempt.prepare("INSERT INTO word_attempts (profile, word_key, attempted_at, correct) VALUES (?, ?, ?, ?)");
+    upsertDeckScore = QSqlQuery(db);
+    upsertDeckScore.prepare("INSERT INTO deck_scores (profile, deck, best_romaji, best_english) VALUES (?, ?, ?, ?)"
+                            " ON CONFLICT (profile, deck) DO UPDATE SET"
+                            " best_romaji = MAX(best_romaji, excluded.best_romaji),"
+                            " best_english = MAX(best_english, excluded.best_english)");
+    return true;
+}
+
+void SqliteStore::close() {
+    if (connection.isEmpty()) return;
+    // Queries and handles must be gone before the connection is removed
+    upsertCharErrors = QSqlQuery();
+    deleteCharErrors = QSqlQuery();
+    insertAttempt = QSqlQuery();
+    upsertDeckScore = QSqlQuery();
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connection);
+    connection.clear();
+}
+
+bool SqliteStore::exec(const QString &sql) {
+    QSqlQuery query(db);
+    if (query.exec(sql)) return true;
+    lastError = query.lastError().text();
+    qDebug() << "SQL failed:" << sql << lastError;
+    return false;
+}
+
+bool SqliteStore::run(QSqlQuery &query) {
+    if (query.exec()) return true;
+    lastError = query.lastError().text();
+    qDebug() << "SQL failed:" << query.lastQuery() << lastError;
+    return false;
+}
+
+bool SqliteStore::createSchema() {
+    for (const char *statement : Schema) {
+        if (!exec(statement)) return false;
+    }
+    return true;
+}
+
+// The JSON files are left in place, so going back to a build without
+// SQLite still finds the data as of the migration.
+bool SqliteStore::migrateFromJson(const QString &profilesDir) {
+    QSqlQuery check(db);
+    check.prepare("SELECT value FROM meta WHERE key = ?");
+    check.addBindValue(MigratedKey);
+    if (!run(check)) return false;
+    if (check.next()) return true;
+
+    // Scores from before per-profile files are split out first
+    VocabularyData::migrateLegacyScores(profilesDir);
+    if (!db.transaction()) return false;
+    bool ok = true;
+    for (const QString &file : QDir(profilesDir).entryList(QStringList() << "*.json", QDir::Files)) {
+        QString profile = QFileInfo(file).baseName();
+        if (profile == "vocabularies" || profile == "vocabulary_scores") continue;
+        QFile in(profilesDir + "/" + file);
+        if (!in.open(QIODevice::ReadOnly)) continue;
+        QJsonObject root = QJsonDocument::fromJson(in.readAll()).object();
+        // Let the engine replay the journal so unfolded changes come along
+        AlphabetQuizEngine engine;
+        engine.setJournalPath(ErrorStatsJournal::pathForProfile(in.fileName()));
+        engine.loadErrorStats(root.value("error_stats").toObject(), root.value("error_stats_journal").toObject());
+        QJsonObject stats = engine.errorStatsJson();
+        for (auto it = stats.begin(); ok && it != stats.end(); ++it)
+            ok = setCharErrors(profile, it.key(), it.value().toInt());
+
+        ProfileScores scores;
+        VocabularyData::loadProfileScores(VocabularyData::scoresFileForProfile(profilesDir, profile), scores);
+        for (auto it = scores.begin(); ok && it != scores.end(); ++it)
+            ok = updateDeckScore(profile, it.key(), it.value().bestRomajiPercent, it.value().bestEnglishPercent);
+    }
+
+    if (ok) {
+        QSqlQuery mark(db);
+        mark.prepare("INSERT INTO meta (key, value) VALUES (?, ?)");
+        mark.addBindValue(MigratedKey);
+        mark.addBindValue(QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+        ok = run(mark);
+    }
+    if (!ok) {
+        db.rollback();
+        return false;
+    }
+    return db.commit();
+}
+
+QJsonObject SqliteStore::charErrors(const QString &profile) {
+    QJsonObject stats;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT char_key, errors FROM char_stats WHERE profile = ?");
+    query.addBindValue(profile);
+    if (!run(query)) return stats;
+    while (query.next())
+        stats[query.value(0).toString()] = query.value(1).toInt();
+    return stats;
+}
+
+bool SqliteStore::setCharErrors(const QString &profile, const QString &charKey, int errors) {
+    if (errors <= 0) {
+        deleteCharErrors.addBindValue(profile);
+        deleteCharErrors.addBindValue(charKey);
+        return run(deleteCharErrors);
+    }
+    upsertCharErrors.addBindValue(profile);
+    upsertCharErrors.addBindValue(charKey);
+    upsertCharErrors.addBindValue(errors);
+    return run(upsertCharErrors);
+}
+
+bool SqliteStore::replaceCharErrors(const QString &profile, const QJsonObject &stats) {
+    if (!db.transaction()) return false;
+    QSqlQuery clear(db);
+    clear.prepare("DELETE FROM char_stats WHERE profile = ?");
+    clear.addBindValue(profile);
+    bool ok = run(clear);
+    for (auto it = stats.begin(); ok && it != stats.end(); ++it)
+        ok = setCharErrors(profile, it.key(), it.value().toInt());
+    if (!ok) {
+        db.rollback();
+        return false;
+    }
+    return db.commit();
+}
+
+bool SqliteStore::recordAttempt(const QString &profile, const QString &wordKey, bool correct, const QDateTime &when) {
+    insertAttempt.addBindValue(profile);
+    insertAttempt.addBindValue(wordKey);
+    insertAttempt.addBindValue(when.toMSecsSinceEpoch());
+    insertAttempt.addBindValue(correct ? 1 : 0);
+    return run(insertAttempt);
+}
+
+std::vector<SqliteStore::WordStats> SqliteStore::hardestWords(const QString &profile, const QDateTime &since, int limit) {
+    std::vector<WordStats> words;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT word_key, COUNT(*) AS attempts, SUM(correct = 0) AS misses"
+                  " FROM word_attempts WHERE profile = ? AND attempted_at >= ?"
+                  " GROUP BY word_key HAVING misses > 0"
+                  " ORDER BY misses DESC, attempts DESC LIMIT ?");
+    query.addBindValue(profile);
+    query.addBindValue(since.toMSecsSinceEpoch());
+    query.addBindValue(limit);
+    if (!run(query)) return words;
+    while (query.next())
+        words.push_back({query.value(0).toString(), query.value(1).toInt(), query.value(2).toInt()});
+    return words;
+}
+
+bool SqliteStore::updateDeckScore(const QString &profile, const QString &deck, double romajiPercent, double englishPercent) {
+    upsertDeckScore.addBindValue(profile);
+    upsertDeckScore.addBindValue(deck);
+    upsertDeckScore.addBindValue(romajiPercent);
+    upsertDeckScore.addBindValue(englishPercent);
+    return run(upsertDeckScore);
+}
+
+bool SqliteStore::loadScores(const QString &profile, ProfileScores &scores) {
+    scores.clear();
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT deck, best_romaji, best_english FROM deck_scores WHERE profile = ?");
+    query.addBindValue(profile);
+    if (!run(query)) return false;
+    while (query.next()) {
+        VocabularyScore &score = scores[query.value(0).toString()];
+        score.bestRomajiPercent = query.value(1).toDouble();
+        score.bestEnglishPercent = query.value(2).toDouble();
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef SQLITESTORE_H
+#define SQLITESTORE_H
+#include <QDateTime>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <vector>
+#include "VocabularyData.h"
+
+// Optional SQLite storage (build with -DQUIZ_SQLITE_STORAGE=ON) for the
+// data that grows with use: per-character error counts, every vocabulary
+// answer and best scores per deck. Each change is a single-row upsert or
+// insert on an indexed table, and queries run in SQL instead of over whole
+// JSON documents.
+//
+// Profile preferences stay in the profile JSON (ProfileStore). On first
+// open, error_stats and the scores file of each profile are imported once.
+// The database runs in WAL mode, so a reader on another connection (e.g.
+// the startup preloader) never blocks a writer.
+//
+// A connection belongs to the thread that opened it.
+class SqliteStore {
+public:
+    struct WordStats {
+        QString wordKey;
+        int attempts = 0;
+        int misses = 0;
+    };
+
+    SqliteStore() = default;
+    SqliteStore(const SqliteStore &) = delete;
+    SqliteStore &operator=(const SqliteStore &) = delete;
+    ~SqliteStore();
+
+    // "<profilesDir>/quiz.sqlite"
+    static QString pathFor(const QString &profilesDir);
+    // Opens (creating the schema if needed) under `connectionName`.
+    bool open(const QString &databasePath, const QString &connectionName);
+    void close();
+    bool isOpen() const { return db.isOpen(); }
+    // Imports the JSON files in `profilesDir` unless that was done before.
+    bool migrateFromJson(const QString &profilesDir);
+
+    // Per-character error counts, keyed "kana|romaji" as in the profile JSON.
+    // A count of 0 removes the row.
+    QJsonObject charErrors(const QString &profile);
+    bool setCharErrors(const QString &profile, const QString &charKey, int errors);
+    bool replaceCharErrors(const QString &profile, const QJsonObject &stats);
+
+    // Vocabulary answers
+    bool recordAttempt(const QString &profile, const QString &wordKey, bool correct,
+                       const QDateTime &when = QDateTime::currentDateTimeUtc());
+    // Most-missed words since `since`, worst first.
+    std::vector<WordStats> hardestWords(const QString &profile, const QDateTime &since, int limit = 50);
+
+    // Best scores per deck
+    bool updateDeckScore(const QString &profile, const QString &deck, double romajiPercent, double englishPercent);
+    bool loadScores(const QString &profile, ProfileScores &scores);
+
+    QString errorString() const { return lastError; }
+
+private:
+    bool exec(const QString &sql);
+    bool run(QSqlQuery &query);
+    bool createSchema();
+
+    QSqlDatabase db;
+    QString connection;
+    QString lastError;
+    QSqlQuery upsertCharErrors;
+    QSqlQuery deleteCharErrors;
+    QSqlQuery insertAttempt;
+    QSqlQuery upsertDeckScore;
+};
+
+#endif // SQLITESTORE_H
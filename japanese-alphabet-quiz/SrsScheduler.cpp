@@ -0,0 +1,244 @@
+#include "SrsScheduler.h"
+#include "AlphabetQuizEngine.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr quint32 Magic = 0x5253514A; // "JQSR"
+constexpr quint32 Version = 1;
+// Key length, two floats, two i64 and two u16
+constexpr qint64 MinRecordBytes = 4 + 2 * 4 + 2 * 8 + 2 * 2;
+constexpr double SecondsPerDay = 86400.0;
+constexpr double MaxIntervalDays = 36500.0;
+
+// FSRS-4.5 default parameters. The forgetting curve is
+// R(t) = (1 + Factor * t / S)^Decay, so R = 0.9 when t = S.
+constexpr double W[17] = {0.4872, 1.4003, 3.7145, 13.8206, 5.1618, 1.2298, 0.8975, 0.031, 1.6474,
+                          0.1367, 1.0461, 2.1072, 0.0793, 0.3246, 1.587, 0.2272, 2.8755};
+constexpr double Decay = -0.5;
+constexpr double Factor = 19.0 / 81.0;
+
+double initialDifficulty(int grade) {
+    return std::clamp(W[4] - W[5] * (grade - 3), 1.0, 10.0);
+}
+
+double nextDifficulty(double d, int grade) {
+    double next = d - W[6] * (grade - 3);
+    // Drift back towards the difficulty of a card first answered Good
+    next = W[7] * initialDifficulty(3) + (1.0 - W[7]) * next;
+    return std::clamp(next, 1.0, 10.0);
+}
+
+double recalledStability(double s, double d, double r, SrsScheduler::Grade grade) {
+    double hardPenalty = grade == SrsScheduler::Grade::Hard ? W[15] : 1.0;
+    double easyBonus = grade == SrsScheduler::Grade::Easy ? W[16] : 1.0;
+    return s * (1.0 + std::exp(W[8]) * (11.0 - d) * std::pow(s, -W[9]) * (std::exp(W[10] * (1.0 - r)) - 1.0)
+                          * hardPenalty * easyBonus);
+}
+
+// Keeps a file that load() cannot read out of the next save's way, so a
+// newer or damaged schedule is not overwritten with an empty one
+void moveAside(const QString &path) {
+    const QString asidePath = path + ".unreadable";
+    QFile::remove(asidePath);
+    if (!QFile::rename(path, asidePath)) qDebug() << "Failed to move aside review schedule:" << path;
+}
+
+double forgottenStability(double s, double d, double r) {
+    double next = W[11] * std::pow(d, -W[12]) * (std::pow(s + 1.0, W[13]) - 1.0) * std::exp(W[14] * (1.0 - r));
+    return std::min(next, s);
+}
+} // namespace
+
+QString SrsScheduler::kanaKey(AlphabetData::CharId id) {
+    return "kana:" + AlphabetQuizEngine::errorStatsKey(id);
+}
+
+QString SrsScheduler::wordKey(DeckStore::WordView word) {
+    QString key;
+    writeWordKey(word, key);
+    return key;
+}
+
+void SrsScheduler::writeWordKey(DeckStore::WordView word, QString &key) {
+    // The same identity the attempt log uses
+    key.resize(0);
+    key += u"word:";
+    key += word.displayText();
+    key += u'|';
+    key += word.romaji();
+    key += u'|';
+    key += word.english();
+}
+
+AlphabetData::CharId SrsScheduler::kanaFromKey(QStringView key) {
+    if (!key.startsWith(u"kana:")) return AlphabetData::InvalidChar;
+    key = key.mid(5);
+    qsizetype bar = key.indexOf(u'|');
+    if (bar < 0) return AlphabetData::InvalidChar;
+    AlphabetData::CharId id = AlphabetData::findKana(key.left(bar));
+    // The romaji is checked too, in case a table row was changed
+    if (id == AlphabetData::InvalidChar || !AlphabetData::romajiEquals(id, key.mid(bar + 1))) return AlphabetData::InvalidChar;
+    return id;
+}
+
+QString SrsScheduler::pathForProfile(const QString &profileJsonPath) {
+    QString base = profileJsonPath;
+    if (base.endsWith(".json")) base.chop(5);
+    return base + ".srs";
+}
+
+void SrsScheduler::clear() {
+    slotByKey.clear();
+    keys.clear();
+    cards.clear();
+    freeSlots.clear();
+    queue.clear();
+    dirty = false;
+}
+
+double SrsScheduler::retrievability(const Card &card, std::int64_t now) {
+    if (card.stability <= 0) return 0.0;
+    double days = std::max<std::int64_t>(0, now - card.lastReview) / SecondsPerDay;
+    return std::pow(1.0 + Factor * days / card.stability, Decay);
+}
+
+void SrsScheduler::review(const QString &key, Grade grade, std::int64_t now) {
+    const int g = static_cast<int>(grade);
+    auto it = slotByKey.constFind(key);
+    const bool isNew = it == slotByKey.constEnd();
+    const std::uint32_t slot = isNew ? slotFor(key) : it.value();
+    Card &card = cards[slot];
+    if (isNew) {
+        card = Card();
+        card.stability = float(W[g - 1]);
+        card.difficulty = float(initialDifficulty(g));
+    } else {
+        double r = retrievability(card, now);
+        double s = grade == Grade::Again ? forgottenStability(card.stability, card.difficulty, r)
+                                         : recalledStability(card.stability, card.difficulty, r, grade);
+        card.stability = float(std::max(s, 0.01));
+        card.difficulty = float(nextDifficulty(card.difficulty, g));
+    }
+    if (grade == Grade::Again) {
+        if (!isNew) ++card.lapses;
+        card.due = now + RelearnSeconds;
+    } else {
+        double days = std::clamp(std::round(double(card.stability)), 1.0, MaxIntervalDays);
+        card.due = now + std::int64_t(days * SecondsPerDay);
+    }
+    card.lastReview = now;
+    if (card.reps < 0xFFFF) ++card.reps;
+    queue.schedule(slot, card.due);
+    dirty = true;
+}
+
+void SrsScheduler::remove(const QString &key) {
+    auto it = slotByKey.find(key);
+    if (it == slotByKey.end()) return;
+    const std::uint32_t slot = it.value();
+    slotByKey.erase(it);
+    queue.remove(slot);
+    keys[slot].clear();
+    freeSlots.push_back(slot);
+    dirty = true;
+}
+
+const SrsScheduler::Card *SrsScheduler::card(const QString &key) const {
+    auto it = slotByKey.constFind(key);
+    return it == slotByKey.constEnd() ? nullptr : &cards[it.value()];
+}
+
+std::vector<QString> SrsScheduler::due(std::int64_t now, std::size_t limit) const {
+    std::vector<QString> result;
+    for (std::uint32_t slot : queue.dueBy(now, limit)) result.push_back(keys[slot]);
+    return result;
+}
+
+std::uint32_t SrsScheduler::slotFor(const QString &key) {
+    std::uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        keys[slot] = key;
+    } else {
+        slot = std::uint32_t(cards.size());
+        keys.push_back(key);
+        cards.emplace_back();
+    }
+    slotByKey.insert(key, slot);
+    return slot;
+}
+
+// Layout: u32 magic, u32 version, u32 count, then per card the key
+// (QDataStream QString), f32 stability, f32 difficulty, i64 due,
+// i64 last review, u16 reps, u16 lapses; all little-endian.
+bool SrsScheduler::load(const QString &path) {
+    clear();
+    QFile file(path);
+    if (!file.exists()) return true; // nothing reviewed yet
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Failed to open review schedule:" << path;
+        return false;
+    }
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != Magic || version != Version) {
+        qDebug() << "Ignoring review schedule in an unknown format:" << path;
+        file.close();
+        moveAside(path);
+        return false;
+    }
+    // The count comes from the file, so it is only trusted as far as the
+    // bytes left could hold records of an empty key
+    const quint64 maxCount = quint64(std::max<qint64>(0, file.size() - file.pos())) / MinRecordBytes;
+    const std::size_t expected = std::size_t(std::min<quint64>(count, maxCount));
+    slotByKey.reserve(qsizetype(expected));
+    cards.reserve(expected);
+    keys.reserve(expected);
+    for (quint32 i = 0; i < count; ++i) {
+        QString key;
+        Card card;
+        qint64 due = 0, lastReview = 0;
+        in >> key >> card.stability >> card.difficulty >> due >> lastReview >> card.reps >> card.lapses;
+        if (in.status() != QDataStream::Ok) break; // keep what was read before a torn tail
+        if (slotByKey.contains(key)) continue;
+        card.due = due;
+        card.lastReview = lastReview;
+        const std::uint32_t slot = slotFor(key);
+        cards[slot] = card;
+        queue.schedule(slot, card.due);
+    }
+    return true;
+}
+
+bool SrsScheduler::save(const QString &path) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to write review schedule:" << path;
+        return false;
+    }
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    out << Magic << Version << quint32(slotByKey.size());
+    for (std::uint32_t slot = 0; slot < cards.size(); ++slot) {
+        if (!queue.contains(slot)) continue; // a removed card's slot
+        const Card &card = cards[slot];
+        out << keys[slot] << card.stability << card.difficulty << qint64(card.due) << qint64(card.lastReview)
+            << card.reps << card.lapses;
+    }
+    if (!file.commit()) {
+        qDebug() << "Failed to write review schedule:" << path;
+        return false;
+    }
+    dirty = false;
+    return true;
+}
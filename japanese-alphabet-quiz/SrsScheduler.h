@@ -0,0 +1,76 @@
+#ifndef SRSSCHEDULER_H
+#define SRSSCHEDULER_H
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <cstdint>
+#include <vector>
+#include "AlphabetData.h"
+#include "DeckStore.h"
+#include "DueQueue.h"
+
+// Spaced-repetition memory for everything a profile has answered, kana and
+// vocabulary words alike. Each card carries an FSRS-style memory state:
+// stability (days until recall falls to 90%) and difficulty (1-10). A
+// review updates both from the grade and the time since the last review,
+// and the next due time is one stability away. Due times are kept in a
+// DueQueue, so finding what is due never scans the cards.
+//
+// Cards are keyed by text that survives table and deck changes:
+// kanaKey() and wordKey(). The state is saved to a binary file per profile.
+class SrsScheduler {
+public:
+    enum class Grade { Again = 1, Hard, Good, Easy };
+    struct Card {
+        float stability = 0;       // days
+        float difficulty = 0;      // 1 (easy) to 10 (hard)
+        std::int64_t due = 0;      // unix seconds
+        std::int64_t lastReview = 0;
+        std::uint16_t reps = 0;
+        std::uint16_t lapses = 0;
+    };
+    // A missed card comes back after this many seconds, not days
+    static constexpr std::int64_t RelearnSeconds = 10 * 60;
+
+    static QString kanaKey(AlphabetData::CharId id);
+    static QString wordKey(DeckStore::WordView word);
+    // Replaces `key` with wordKey(word), reusing its buffer.
+    static void writeWordKey(DeckStore::WordView word, QString &key);
+    // The character a kanaKey() names; InvalidChar for other keys.
+    static AlphabetData::CharId kanaFromKey(QStringView key);
+    static bool isWordKey(QStringView key) { return key.startsWith(u"word:"); }
+    // "<profile>.srs" next to the profile's JSON file
+    static QString pathForProfile(const QString &profileJsonPath);
+
+    void clear();
+    // Replaces the cards with the file's; a missing file is an empty schedule.
+    // A file in an unknown format is renamed to "<path>.unreadable".
+    bool load(const QString &path);
+    // Writes every card atomically and clears the dirty flag.
+    bool save(const QString &path);
+    bool isDirty() const { return dirty; }
+
+    // Grades one answer; an unknown key becomes a new card.
+    void review(const QString &key, Grade grade, std::int64_t now);
+    void remove(const QString &key);
+    // Null if the key has never been reviewed.
+    const Card *card(const QString &key) const;
+    std::size_t size() const { return queue.size(); }
+    std::size_t dueCount(std::int64_t now) const { return queue.countDueBy(now); }
+    // Up to `limit` keys due at or before `now`, most overdue first.
+    std::vector<QString> due(std::int64_t now, std::size_t limit) const;
+    // Chance of recalling the card at `now`, from its stability.
+    static double retrievability(const Card &card, std::int64_t now);
+
+private:
+    std::uint32_t slotFor(const QString &key);
+
+    QHash<QString, std::uint32_t> slotByKey;
+    std::vector<QString> keys;  // by slot; empty once removed
+    std::vector<Card> cards;    // by slot
+    std::vector<std::uint32_t> freeSlots;
+    DueQueue queue;
+    bool dirty = false;
+};
+
+#endif // SRSSCHEDULER_H
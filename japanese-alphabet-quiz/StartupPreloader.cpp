@@ -0,0 +1,81 @@
+#include "StartupPreloader.h"
+#include <QtConcurrent>
+#ifdef QUIZ_SQLITE_STORAGE
+#include <QThread>
+#include "SqliteStore.h"
+#endif
+
+StartupPreloader::StartupPreloader(const QString &profilesDir, QObject *parent)
+    : QObject(parent), profilesDir(profilesDir) {
+    connect(&deckWatcher, &QFutureWatcherBase::finished, this, &StartupPreloader::decksLoaded);
+    connect(&scoresWatcher, &QFutureWatcherBase::finished, this, &StartupPreloader::scoresLoaded);
+}
+
+StartupPreloader::~StartupPreloader() {
+    // Workers write into this object's signals; let them finish first
+    cancelDecks = true;
+    deckWatcher.waitForFinished();
+    scoresWatcher.waitForFinished();
+}
+
+void StartupPreloader::start() {
+    QString vocabFile = profilesDir + "/vocabularies.json";
+    deckWatcher.setFuture(QtConcurrent::run([this, vocabFile]() {
+        auto store = std::make_shared<DeckStore>();
+        decksRead = VocabularyData::loadVocabularies(vocabFile, *store,
+            [this](qint64 bytesRead, qint64 totalBytes, const DeckStore &loaded) {
+                emit deckProgress(bytesRead, totalBytes, loaded.deckCount());
+                return !cancelDecks.load();
+            });
+        return store;
+    }));
+    // Split an old all-profiles scores file before any profile reads its own
+    QString dir = profilesDir;
+    scoresWatcher.setFuture(QtConcurrent::run([dir]() {
+        VocabularyData::migrateLegacyScores(dir);
+        return ProfileScores();
+    }));
+}
+
+void StartupPreloader::setProfile(const QString &name) {
+    profileName = name;
+    reloadScores();
+}
+
+void StartupPreloader::reloadScores() {
+    scoresWatcher.waitForFinished();
+    if (profileName.isEmpty()) return;
+    QString path = scoresFile();
+    QString dbPath = databasePath;
+    QString name = profileName;
+    scoresWatcher.setFuture(QtConcurrent::run([path, dbPath, name]() {
+        ProfileScores scores;
+#ifdef QUIZ_SQLITE_STORAGE
+        if (!dbPath.isEmpty()) {
+            // A connection of our own: the GUI thread's cannot be used here
+            SqliteStore db;
+            QString connection = QString("scores-%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()));
+            if (db.open(dbPath, connection)) db.loadScores(name, scores);
+            return scores;
+        }
+#else
+        Q_UNUSED(dbPath);
+        Q_UNUSED(name);
+#endif
+        VocabularyData::loadProfileScores(path, scores);
+        return scores;
+    }));
+}
+
+std::shared_ptr<const DeckStore> StartupPreloader::decks() {
+    if (deckWatcher.future().isCanceled()) return std::make_shared<DeckStore>();
+    return deckWatcher.result();
+}
+
+ProfileScores StartupPreloader::scores() {
+    return scoresWatcher.result();
+}
+
+QString StartupPreloader::scoresFile() const {
+    return VocabularyData::scoresFileForProfile(profilesDir, profileName);
+}
@@ -0,0 +1,60 @@
+#ifndef STARTUPPRELOADER_H
+#define STARTUPPRELOADER_H
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include "DeckStore.h"
+#include "VocabularyData.h"
+
+// Reads vocabularies.json on a worker thread while the splash screen and
+// profile dialog are up, so the Vocabularies screen has its data ready on
+// first use. The decks are kept for the session. Once a profile is chosen
+// its scores are read in the background too, and again after each quiz.
+class StartupPreloader : public QObject {
+    Q_OBJECT
+public:
+    explicit StartupPreloader(const QString &profilesDir, QObject *parent = nullptr);
+    ~StartupPreloader() override;
+
+    // Read scores from this SQLite file instead of vocabulary_scores.json
+    // (QUIZ_SQLITE_STORAGE builds). Call before start().
+    void setDatabasePath(const QString &path) { databasePath = path; }
+    void start();
+    // Loads `name`'s scores; scores() is empty until a profile is set.
+    void setProfile(const QString &name);
+    void reloadScores();
+
+    bool decksReady() const { return deckWatcher.isFinished(); }
+    // True once every deck was read; false after a cancelled or failed load,
+    // whose store may be partial or empty.
+    bool decksComplete() const { return decksReady() && decksRead.load(); }
+    bool scoresReady() const { return scoresWatcher.isFinished(); }
+    // Block until the load is done; connect to decksLoaded() to wait without blocking.
+    std::shared_ptr<const DeckStore> decks();
+    ProfileScores scores();
+    // The current profile's scores file
+    QString scoresFile() const;
+
+public slots:
+    // Stops the deck load early, keeping the decks read so far.
+    void cancelDeckLoad() { cancelDecks = true; }
+
+signals:
+    // Emitted from the worker thread; use a queued or auto connection.
+    void deckProgress(qint64 bytesRead, qint64 totalBytes, int decksLoaded);
+    void decksLoaded();
+    void scoresLoaded();
+
+private:
+    QString profilesDir;
+    QString databasePath;
+    QString profileName;
+    QFutureWatcher<std::shared_ptr<DeckStore>> deckWatcher;
+    QFutureWatcher<ProfileScores> scoresWatcher;
+    std::atomic_bool cancelDecks{false};
+    std::atomic_bool decksRead{false};
+};
+
+#endif // STARTUPPRELOADER_H
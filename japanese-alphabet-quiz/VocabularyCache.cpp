@@ -0,0 +1,265 @@
+#include "VocabularyCache.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+// On-disk layout, native little-endian (other hosts just never use a cache):
+//   Header | DeckRecord[deckCount] | StringRef[FieldCount][wordCount]
+//   | the AnswerMatcher index | char16_t text[]
+// Each array is a Section; they follow one another in SectionId order, and
+// the 2-byte text arrays come last so every other array stays 4-byte aligned.
+enum SectionId {
+    Decks,
+    Columns,
+    AnswerEntries,
+    AnswerFirst,
+    AnswerSlots,
+    AnswerReadings,
+    TrieNodes,
+    TrieRoots,
+    AnswerText,
+    Text,
+    SectionCount
+};
+
+struct VocabularyCache::Section {
+    std::uint64_t offset;
+    std::uint64_t count; // elements, not bytes
+};
+
+struct VocabularyCache::Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t wordCount;
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtimeMs;
+    std::uint64_t sourceHash;
+    Section sections[SectionCount];
+};
+static_assert(sizeof(DeckStore::StringRef) == 8 && sizeof(DeckStore::DeckRecord) == 16,
+              "DeckStore records are written to the cache as they are");
+static_assert(sizeof(AnswerMatcher::Entry) == 16 && sizeof(AnswerMatcher::Reading) == 12
+                  && sizeof(AnswerTrie::Node) == 12,
+              "AnswerMatcher records are written to the cache as they are");
+
+namespace {
+constexpr char Magic[4] = {'J', 'Q', 'V', 'C'};
+constexpr std::uint32_t Version = 3;
+constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+constexpr std::size_t ElementSize[SectionCount] = {
+    sizeof(DeckStore::DeckRecord), sizeof(DeckStore::StringRef), sizeof(AnswerMatcher::Entry),
+    sizeof(std::uint32_t),         sizeof(std::uint32_t),        sizeof(AnswerMatcher::Reading),
+    sizeof(AnswerTrie::Node),      sizeof(std::uint32_t),        sizeof(char16_t),
+    sizeof(char16_t),
+};
+
+struct SourceStamp {
+    qint64 size = -1;
+    qint64 mtimeMs = 0;
+};
+
+SourceStamp stampOf(const QString &path) {
+    QFileInfo info(path);
+    if (!info.exists()) return {};
+    return {info.size(), info.lastModified().toMSecsSinceEpoch()};
+}
+
+// FNV-1a over the file, only needed when size matches but mtime does not
+std::uint64_t hashOf(const QString &path) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return 0;
+    std::uint64_t h = 14695981039346656037ull;
+    while (!f.atEnd()) {
+        QByteArray chunk = f.read(1 << 20);
+        for (char c : chunk) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+    }
+    return h;
+}
+}
+
+QString VocabularyCache::cachePathFor(const QString &jsonPath) {
+    QString base = jsonPath;
+    if (base.endsWith(".json")) base.chop(5);
+    return base + ".jqvc";
+}
+
+bool VocabularyCache::build(const DeckStore &store, const QString &jsonPath, const QString &cachePath) {
+    if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN) return false;
+    Header h{};
+    std::memcpy(h.magic, Magic, sizeof Magic);
+    h.version = Version;
+    h.byteOrder = ByteOrderMark;
+    SourceStamp stamp = stampOf(jsonPath);
+    if (stamp.size < 0) return false;
+    h.sourceSize = static_cast<std::uint64_t>(stamp.size);
+    h.sourceMtimeMs = stamp.mtimeMs;
+    h.sourceHash = hashOf(jsonPath);
+    h.wordCount = static_cast<std::uint32_t>(store.wordCount());
+
+    // The store and its answer index are already in cache layout; write
+    // their arrays as they are
+    const AnswerMatcher::View &answers = store.answers().arrays();
+    std::array<const void *, SectionCount> arrays{};
+    arrays[Decks] = store.decks();
+    h.sections[Decks].count = std::uint64_t(store.deckCount());
+    h.sections[Columns].count = std::uint64_t(h.wordCount) * DeckStore::FieldCount;
+    arrays[AnswerEntries] = answers.entries;
+    h.sections[AnswerEntries].count = answers.entryCount;
+    arrays[AnswerFirst] = answers.first;
+    h.sections[AnswerFirst].count = answers.firstCount;
+    arrays[AnswerSlots] = answers.slots;
+    h.sections[AnswerSlots].count = answers.slotCount;
+    arrays[AnswerReadings] = answers.readings;
+    h.sections[AnswerReadings].count = answers.readingCount;
+    arrays[TrieNodes] = answers.trie.nodes;
+    h.sections[TrieNodes].count = answers.trie.nodeCount;
+    arrays[TrieRoots] = answers.trie.roots;
+    h.sections[TrieRoots].count = answers.trie.rootCount;
+    arrays[AnswerText] = answers.text;
+    h.sections[AnswerText].count = answers.textUnits;
+    arrays[Text] = store.text();
+    h.sections[Text].count = store.textUnits();
+    std::uint64_t offset = sizeof(Header);
+    for (int s = 0; s < SectionCount; ++s) {
+        h.sections[s].offset = offset;
+        offset += h.sections[s].count * ElementSize[s];
+    }
+
+    QSaveFile out(cachePath);
+    if (!out.open(QIODevice::WriteOnly)) return false;
+    out.write(reinterpret_cast<const char *>(&h), sizeof h);
+    for (int s = 0; s < SectionCount; ++s) {
+        if (s == Columns) {
+            for (int f = 0; f < DeckStore::FieldCount; ++f)
+                out.write(reinterpret_cast<const char *>(store.column(static_cast<DeckStore::Field>(f))),
+                          qint64(h.wordCount * sizeof(DeckStore::StringRef)));
+            continue;
+        }
+        out.write(static_cast<const char *>(arrays[s]), qint64(h.sections[s].count * ElementSize[s]));
+    }
+    if (!out.commit()) {
+        qDebug() << "Failed to write vocabulary cache:" << cachePath << out.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool VocabularyCache::open(const QString &cachePath, const QString &jsonPath) {
+    close();
+    if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN) return false;
+    file.setFileName(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    size = file.size();
+    if (size < qint64(sizeof(Header)) || !(data = file.map(0, size))) {
+        close();
+        return false;
+    }
+    const Header *h = reinterpret_cast<const Header *>(data);
+    bool valid = std::memcmp(h->magic, Magic, sizeof Magic) == 0
+              && h->version == Version && h->byteOrder == ByteOrderMark
+              && h->sections[Columns].count == std::uint64_t(h->wordCount) * DeckStore::FieldCount;
+    // Sections must sit where the counts say and fit in the file
+    std::uint64_t offset = sizeof(Header);
+    for (int s = 0; valid && s < SectionCount; ++s) {
+        valid = h->sections[s].offset == offset && h->sections[s].count <= std::uint64_t(size) / ElementSize[s]
+             && h->sections[s].count <= std::numeric_limits<std::uint32_t>::max();
+        offset += h->sections[s].count * ElementSize[s];
+    }
+    valid = valid && offset == std::uint64_t(size);
+    SourceStamp stamp = stampOf(jsonPath);
+    if (valid && (stamp.size < 0 || std::uint64_t(stamp.size) != h->sourceSize)) valid = false;
+    // Same size but touched (copied, checked out): trust it only if the bytes match
+    const bool touched = valid && stamp.mtimeMs != h->sourceMtimeMs;
+    if (touched && hashOf(jsonPath) != h->sourceHash) valid = false;
+    if (!valid) {
+        close();
+        return false;
+    }
+    header = h;
+    if (touched) restamp(stamp.mtimeMs);
+    return true;
+}
+
+// Records the source's new mtime, so the next open skips the hash again.
+// Best effort: a read-only cache is still served, just hashed each time.
+void VocabularyCache::restamp(qint64 sourceMtimeMs) {
+    QFile out(file.fileName());
+    if (!out.open(QIODevice::ReadWrite) || !out.seek(qint64(offsetof(Header, sourceMtimeMs)))) return;
+    const std::int64_t mtime = sourceMtimeMs;
+    if (out.write(reinterpret_cast<const char *>(&mtime), sizeof mtime) != qint64(sizeof mtime))
+        qDebug() << "Failed to restamp vocabulary cache:" << file.fileName();
+}
+
+void VocabularyCache::close() {
+    if (data) file.unmap(const_cast<uchar *>(data));
+    if (file.isOpen()) file.close();
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+}
+
+int VocabularyCache::deckCount() const {
+    return header ? int(header->sections[Decks].count) : 0;
+}
+
+int VocabularyCache::wordCount() const {
+    return header ? int(header->wordCount) : 0;
+}
+
+template <typename T>
+const T *VocabularyCache::section(int id) const {
+    return header ? reinterpret_cast<const T *>(data + header->sections[id].offset) : nullptr;
+}
+
+std::uint32_t VocabularyCache::count(int id) const {
+    return header ? std::uint32_t(header->sections[id].count) : 0;
+}
+
+const DeckStore::DeckRecord *VocabularyCache::decks() const {
+    return section<DeckStore::DeckRecord>(Decks);
+}
+
+const DeckStore::StringRef *VocabularyCache::column(DeckStore::Field field) const {
+    if (!header) return nullptr;
+    return section<DeckStore::StringRef>(Columns) + std::size_t(field) * header->wordCount;
+}
+
+const char16_t *VocabularyCache::text() const {
+    return section<char16_t>(Text);
+}
+
+std::uint32_t VocabularyCache::textUnits() const {
+    return count(Text);
+}
+
+AnswerMatcher::View VocabularyCache::answers() const {
+    AnswerMatcher::View v;
+    if (!header) return v;
+    v.text = section<char16_t>(AnswerText);
+    v.textUnits = count(AnswerText);
+    v.entries = section<AnswerMatcher::Entry>(AnswerEntries);
+    v.entryCount = count(AnswerEntries);
+    v.first = section<std::uint32_t>(AnswerFirst);
+    v.firstCount = count(AnswerFirst);
+    v.slots = section<std::uint32_t>(AnswerSlots);
+    v.slotCount = count(AnswerSlots);
+    v.readings = section<AnswerMatcher::Reading>(AnswerReadings);
+    v.readingCount = count(AnswerReadings);
+    v.trie.nodes = section<AnswerTrie::Node>(TrieNodes);
+    v.trie.nodeCount = count(TrieNodes);
+    v.trie.roots = section<std::uint32_t>(TrieRoots);
+    v.trie.rootCount = count(TrieRoots);
+    // A table that is not a power of two could not have been written here
+    if (v.slotCount & (v.slotCount - 1)) v.slotCount = 0;
+    return v;
+}
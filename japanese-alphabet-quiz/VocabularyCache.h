@@ -0,0 +1,58 @@
+#ifndef VOCABULARYCACHE_H
+#define VOCABULARYCACHE_H
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include "DeckStore.h"
+
+// Compiled, memory-mapped form of vocabularies.json. The file is a DeckStore
+// laid out flat: a header, the deck index, one offset/length column per word
+// field, the store's AnswerMatcher index and the UTF-16 text arena, so
+// opening it is a map plus a header check and a DeckStore can serve words
+// and check answers straight from the mapping. Processes mapping the same
+// cache share its pages.
+//
+// The header records the size, mtime and a hash of the JSON it was built
+// from; a cache whose source changed is rebuilt rather than served. A
+// source that was only touched is hashed once and the new mtime recorded.
+class VocabularyCache {
+public:
+    VocabularyCache() = default;
+    VocabularyCache(const VocabularyCache &) = delete;
+    VocabularyCache &operator=(const VocabularyCache &) = delete;
+    ~VocabularyCache() { close(); }
+
+    // "vocabularies.json" -> "vocabularies.jqvc"
+    static QString cachePathFor(const QString &jsonPath);
+    // Compiles `store`, as read from `jsonPath`, into `cachePath`.
+    static bool build(const DeckStore &store, const QString &jsonPath, const QString &cachePath);
+
+    // Maps `cachePath` if it is valid for the current `jsonPath`.
+    bool open(const QString &cachePath, const QString &jsonPath);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // Arrays point into the mapping and stay valid until close().
+    int deckCount() const;
+    int wordCount() const;
+    const DeckStore::DeckRecord *decks() const;
+    const DeckStore::StringRef *column(DeckStore::Field field) const;
+    const char16_t *text() const;
+    std::uint32_t textUnits() const;
+    AnswerMatcher::View answers() const;
+
+private:
+    struct Section;
+    struct Header;
+    template <typename T>
+    const T *section(int id) const;
+    std::uint32_t count(int id) const;
+    void restamp(qint64 sourceMtimeMs);
+
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 size = 0;
+    const Header *header = nullptr;
+};
+
+#endif // VOCABULARYCACHE_H
@@ -1,12 +1,19 @@
 #include "VocabularyData.h"
+#include "VocabularyCache.h"
+#include "VocabularyStreamReader.h"
 #include <QJsonDocument>
 #include <QJsonParseError>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QUrl>
 #include <QDebug>
 #include <algorithm>
 
-bool VocabularyData::loadVocabularies(const QString &filePath, std::vector<Vocabulary> &vocabularies) {
-    vocabularies.clear();
+bool VocabularyData::loadVocabularies(const QString &filePath, DeckStore &store, const LoadProgress &progress) {
+    store.clear();
     
     QFile file(filePath);
     if (!file.exists()) {
@@ -24,48 +31,40 @@ bool VocabularyData::loadVocabularies(const QString &filePath, std::vector<Vocab
         defaultVocabs.push_back(basicVocab);
         
         saveVocabularies(filePath, defaultVocabs);
-        vocabularies = defaultVocabs;
+        store = DeckStore::fromVocabularies(defaultVocabs);
         return true;
     }
     
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Failed to open vocabulary file:" << filePath;
-        return false;
-    }
-    
-    QByteArray data = file.readAll();
-    file.close();
-    
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    
-    if (parseError.error != QJsonParseError::NoError) {
-        qDebug() << "JSON parse error:" << parseError.errorString();
-        return false;
-    }
-    
-    if (!doc.isObject()) {
-        qDebug() << "Invalid JSON structure - not an object";
-        return false;
+    // Serve the compiled cache if it was built from this exact file
+    QString cachePath = VocabularyCache::cachePathFor(filePath);
+    auto cache = std::make_shared<VocabularyCache>();
+    if (cache->open(cachePath, filePath)) {
+        store.adopt(std::move(cache));
+        return true;
     }
     
-    QJsonObject root = doc.object();
-    if (!root.contains("Vocabularies") || !root["Vocabularies"].isArray()) {
-        qDebug() << "Missing or invalid 'Vocabularies' array";
+    // Stream the file so large decks never exist as a JSON DOM; each deck
+    // goes into the store as soon as it has been read
+    VocabularyStreamReader reader;
+    reader.setVocabularyHandler([&store](Vocabulary &vocab) {
+        store.addDeck(vocab);
+        return true;
+    });
+    if (progress) {
+        reader.setProgressHandler([&store, &progress](qint64 bytesRead, qint64 totalBytes) {
+            return progress(bytesRead, totalBytes, store);
+        });
+    }
+    bool ok = reader.readFile(filePath);
+    if (!ok && !reader.wasCancelled()) {
+        qDebug() << "Vocabulary parse error:" << reader.errorString();
+        store.clear();
         return false;
     }
-    
-    QJsonArray vocabArray = root["Vocabularies"].toArray();
-    for (const QJsonValue &value : vocabArray) {
-        if (value.isObject()) {
-            Vocabulary vocab = parseVocabulary(value.toObject());
-            if (!vocab.name.isEmpty()) {
-                vocabularies.push_back(vocab);
-            }
-        }
-    }
-    
-    return true;
+    // A cancelled load keeps the decks read so far
+    store.squeeze();
+    if (ok) VocabularyCache::build(store, filePath, cachePath);
+    return ok;
 }
 
 bool VocabularyData::saveVocabularies(const QString &filePath, const std::vector<Vocabulary> &vocabularies) {
@@ -87,70 +86,12 @@ bool VocabularyData::saveVocabularies(const QString &filePath, const std::vector
     QJsonDocument doc(root);
     file.write(doc.toJson(QJsonDocument::Indented));
     file.close();
+    // A rewrite within the mtime granularity could pass for the old file
+    QFile::remove(VocabularyCache::cachePathFor(filePath));
     
     return true;
 }
 
-std::vector<VocabularyWord> VocabularyData::getAllWords(const std::vector<Vocabulary> &vocabularies) {
-    std::vector<VocabularyWord> allWords;
-    
-    for (const Vocabulary &vocab : vocabularies) {
-        for (const VocabularyWord &word : vocab.words) {
-            allWords.push_back(word);
-        }
-    }
-    
-    return allWords;
-}
-
-Vocabulary VocabularyData::parseVocabulary(const QJsonObject &vocabObj) {
-    Vocabulary vocab;
-    
-    if (vocabObj.contains("Vocabulary") && vocabObj["Vocabulary"].isString()) {
-        vocab.name = vocabObj["Vocabulary"].toString();
-    }
-    
-    if (vocabObj.contains("words") && vocabObj["words"].isArray()) {
-        QJsonArray wordsArray = vocabObj["words"].toArray();
-        
-        for (const QJsonValue &wordValue : wordsArray) {
-            if (wordValue.isObject()) {
-                QJsonObject wordObj = wordValue.toObject();
-                VocabularyWord word;
-                if (wordObj.contains("japanese") && word.hiragana.isEmpty()) { // backwards compatibility
-                    word.hiragana = wordObj["japanese"].toString();
-                }
-                if (wordObj.contains("hiragana")) {
-                    word.hiragana = wordObj["hiragana"].toString();
-                }
-                if (wordObj.contains("katakana")) {
-                    word.katakana = wordObj["katakana"].toString();
-                }
-                if (wordObj.contains("romaji")) {
-                    word.romaji = wordObj["romaji"].toString();
-                }
-                if (wordObj.contains("english")) {
-                    word.english = wordObj["english"].toString();
-                }
-                if (wordObj.contains("kanji")) {
-                    word.kanji = wordObj["kanji"].toString();
-                }
-                if (wordObj.contains("comment")) {
-                    word.comment = wordObj["comment"].toString();
-                }
-                if (wordObj.contains("hint")) {
-                    word.hint = wordObj["hint"].toString();
-                }
-                if (!word.hiragana.isEmpty() && !word.romaji.isEmpty() && !word.english.isEmpty()) {
-                    vocab.words.push_back(word);
-                }
-            }
-        }
-    }
-    
-    return vocab;
-}
-
 QJsonObject VocabularyData::vocabularyToJson(const Vocabulary &vocab) {
     QJsonObject vocabObj;
     vocabObj["Vocabulary"] = vocab.name;
@@ -169,106 +110,116 @@ QJsonObject VocabularyData::vocabularyToJson(const Vocabulary &vocab) {
     return vocabObj;
 }
 
-bool VocabularyData::loadProfileScores(const QString &filePath, ProfileScores &scores) {
-    scores.clear();
-    
+QString VocabularyData::scoresFileForProfile(const QString &profilesDir, const QString &profileName) {
+    // Percent-encode all but ASCII letters, digits, '-' and '_', so a name
+    // with '/', ".." or characters Windows rejects stays one file in scores/
+    QString fileName = QString::fromLatin1(QUrl::toPercentEncoding(profileName, QByteArray(), ".~"));
+    // Windows also reserves device names whatever the extension
+    static const QRegularExpression deviceName("^(con|prn|aux|nul|com[1-9]|lpt[1-9])$",
+                                               QRegularExpression::CaseInsensitiveOption);
+    if (deviceName.match(fileName).hasMatch())
+        fileName = QString::asprintf("%%%02X", fileName.at(0).unicode()) + fileName.mid(1);
+    return profilesDir + "/scores/" + fileName + ".json";
+}
+
+// Reads {"vocabulary": {"bestRomajiPercent": .., "bestEnglishPercent": ..}, ...}
+static bool readScoresObject(const QString &filePath, QJsonObject &root) {
     QFile file(filePath);
     if (!file.exists()) {
-        return true; // Empty scores file is valid
+        return true; // No scores yet
     }
-    
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         qDebug() << "Failed to open scores file:" << filePath;
         return false;
     }
-    
-    QByteArray data = file.readAll();
-    file.close();
-    
     QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
     if (parseError.error != QJsonParseError::NoError) {
-        qDebug() << "JSON parse error in scores:" << parseError.errorString();
+        qDebug() << "JSON parse error in scores:" << filePath << parseError.errorString();
         return false;
     }
-    
-    if (!doc.isObject()) {
-        return true; // Empty/invalid file, start fresh
-    }
-    
-    QJsonObject root = doc.object();
-    for (auto profileIt = root.begin(); profileIt != root.end(); ++profileIt) {
-        QString profileName = profileIt.key();
-        if (profileIt.value().isObject()) {
-            QJsonObject profileObj = profileIt.value().toObject();
-            std::map<QString, VocabularyScore> profileScores;
-            
-            for (auto vocabIt = profileObj.begin(); vocabIt != profileObj.end(); ++vocabIt) {
-                QString vocabName = vocabIt.key();
-                if (vocabIt.value().isObject()) {
-                    VocabularyScore score = parseScore(vocabIt.value().toObject());
-                    profileScores[vocabName] = score;
-                }
-            }
-            scores[profileName] = profileScores;
-        }
+    root = doc.object(); // Empty/invalid file, start fresh
+    return true;
+}
+
+bool VocabularyData::loadProfileScores(const QString &filePath, ProfileScores &scores) {
+    scores.clear();
+    QJsonObject root;
+    if (!readScoresObject(filePath, root)) return false;
+    scores.reserve(root.size());
+    for (auto it = root.begin(); it != root.end(); ++it) {
+        if (it.value().isObject()) scores.insert(it.key(), parseScore(it.value().toObject()));
     }
-    
     return true;
 }
 
 bool VocabularyData::saveProfileScores(const QString &filePath, const ProfileScores &scores) {
     QJsonObject root;
-    
-    for (const auto &profilePair : scores) {
-        const QString &profileName = profilePair.first;
-        const auto &profileScores = profilePair.second;
-        
-        QJsonObject profileObj;
-        for (const auto &vocabPair : profileScores) {
-            const QString &vocabName = vocabPair.first;
-            const VocabularyScore &score = vocabPair.second;
-            
-            profileObj[vocabName] = scoreToJson(score);
-        }
-        root[profileName] = profileObj;
+    for (auto it = scores.begin(); it != scores.end(); ++it) {
+        root[it.key()] = scoreToJson(it.value());
     }
-    
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    // Replace the file atomically so a crash never leaves half a shard
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
         qDebug() << "Failed to open scores file for writing:" << filePath;
         return false;
     }
-    
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
-    
-    return true;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
 }
 
-VocabularyScore VocabularyData::getProfileVocabularyScore(const ProfileScores &scores, 
-                                                         const QString &profileName, 
-                                                         const QString &vocabularyName) {
-    auto profileIt = scores.find(profileName);
-    if (profileIt != scores.end()) {
-        auto vocabIt = profileIt->second.find(vocabularyName);
-        if (vocabIt != profileIt->second.end()) {
-            return vocabIt->second;
-        }
-    }
-    return VocabularyScore(); // Default (0.0, 0.0)
+VocabularyScore VocabularyData::getProfileVocabularyScore(const ProfileScores &scores, const QString &vocabularyName) {
+    return scores.value(vocabularyName); // Default (0.0, 0.0)
 }
 
-void VocabularyData::updateProfileVocabularyScore(ProfileScores &scores,
-                                                 const QString &profileName,
-                                                 const QString &vocabularyName,
-                                                 double romajiPercent,
-                                                 double englishPercent) {
-    VocabularyScore &score = scores[profileName][vocabularyName];
+bool VocabularyData::updateProfileVocabularyScore(ProfileScores &scores,
+                                                  const QString &vocabularyName,
+                                                  double romajiPercent,
+                                                  double englishPercent) {
+    VocabularyScore &score = scores[vocabularyName];
+    if (romajiPercent <= score.bestRomajiPercent && englishPercent <= score.bestEnglishPercent) return false;
     score.bestRomajiPercent = std::max(score.bestRomajiPercent, romajiPercent);
     score.bestEnglishPercent = std::max(score.bestEnglishPercent, englishPercent);
+    return true;
+}
+
+bool VocabularyData::migrateLegacyScores(const QString &profilesDir) {
+    QString legacyPath = profilesDir + "/vocabulary_scores.json";
+    if (!QFile::exists(legacyPath)) return true;
+    // {"profile": {"vocabulary": score, ...}, ...}
+    QJsonObject legacy;
+    if (!readScoresObject(legacyPath, legacy)) return false;
+    bool ok = true;
+    for (auto profileIt = legacy.begin(); profileIt != legacy.end(); ++profileIt) {
+        if (!profileIt.value().isObject()) continue;
+        // Merge into a shard that may already exist, keeping the best scores
+        QString shardPath = scoresFileForProfile(profilesDir, profileIt.key());
+        ProfileScores scores;
+        if (!loadProfileScores(shardPath, scores)) {
+            // Keep a shard that will not parse rather than write over it
+            QString corruptPath = shardPath + ".corrupt";
+            QFile::remove(corruptPath);
+            if (!QFile::rename(shardPath, corruptPath)) {
+                qDebug() << "Skipping scores that cannot be merged into:" << shardPath;
+                ok = false;
+                continue;
+            }
+            scores.clear();
+        }
+        QJsonObject profileObj = profileIt.value().toObject();
+        for (auto vocabIt = profileObj.begin(); vocabIt != profileObj.end(); ++vocabIt) {
+            if (!vocabIt.value().isObject()) continue;
+            VocabularyScore score = parseScore(vocabIt.value().toObject());
+            updateProfileVocabularyScore(scores, vocabIt.key(), score.bestRomajiPercent, score.bestEnglishPercent);
+        }
+        ok = saveProfileScores(shardPath, scores) && ok;
+    }
+    // Keep the old file until every shard is written; merging again is harmless
+    if (!ok) return false;
+    QString migratedPath = legacyPath + ".migrated";
+    QFile::remove(migratedPath);
+    return QFile::rename(legacyPath, migratedPath);
 }
 
 QJsonObject VocabularyData::scoreToJson(const VocabularyScore &score) {
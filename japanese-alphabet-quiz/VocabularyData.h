@@ -1,6 +1,7 @@
 #ifndef VOCABULARYDATA_H
 #define VOCABULARYDATA_H
 
+#include <QHash>
 #include <QString>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -8,10 +9,12 @@
 #include <map>
 #include <cstddef>
 #include <algorithm>
+#include <functional>
 
 // Forward declarations
 class QString;
 class QJsonObject;
+class DeckStore;
 
 struct VocabularyWord {
     QString romaji;
@@ -33,29 +36,37 @@ struct Vocabulary {
     std::vector<VocabularyWord> words;
 };
 
-// Profile-based vocabulary scores
-using ProfileScores = std::map<QString, std::map<QString, VocabularyScore>>; // [profileName][vocabularyName] -> scores
+// One profile's best scores, keyed by vocabulary name. Each profile's
+// scores live in their own file (see scoresFileForProfile).
+using ProfileScores = QHash<QString, VocabularyScore>;
 
 class VocabularyData {
 public:
-    static bool loadVocabularies(const QString &filePath, std::vector<Vocabulary> &vocabularies);
+    // Receives the decks read so far; return false to stop loading.
+    using LoadProgress = std::function<bool(qint64 bytesRead, qint64 totalBytes, const DeckStore &loaded)>;
+    static bool loadVocabularies(const QString &filePath, DeckStore &store,
+                                 const LoadProgress &progress = LoadProgress());
     static bool saveVocabularies(const QString &filePath, const std::vector<Vocabulary> &vocabularies);
-    static std::vector<VocabularyWord> getAllWords(const std::vector<Vocabulary> &vocabularies);
     
     // Score management
+    // "<profilesDir>/scores/<profileName>.json", the name percent-encoded
+    // so it is always a plain file name
+    static QString scoresFileForProfile(const QString &profilesDir, const QString &profileName);
     static bool loadProfileScores(const QString &filePath, ProfileScores &scores);
     static bool saveProfileScores(const QString &filePath, const ProfileScores &scores);
-    static VocabularyScore getProfileVocabularyScore(const ProfileScores &scores, 
-                                                    const QString &profileName, 
-                                                    const QString &vocabularyName);
-    static void updateProfileVocabularyScore(ProfileScores &scores,
-                                           const QString &profileName,
-                                           const QString &vocabularyName,
-                                           double romajiPercent,
-                                           double englishPercent);
+    static VocabularyScore getProfileVocabularyScore(const ProfileScores &scores, const QString &vocabularyName);
+    // Keeps the better of the stored and new percentages; true if either improved.
+    static bool updateProfileVocabularyScore(ProfileScores &scores,
+                                             const QString &vocabularyName,
+                                             double romajiPercent,
+                                             double englishPercent);
+    // Splits the old all-profiles vocabulary_scores.json into per-profile
+    // files and renames it to vocabulary_scores.json.migrated. Does nothing
+    // once the old file is gone. A shard that fails to parse is kept as
+    // "<shard>.corrupt" rather than merged over.
+    static bool migrateLegacyScores(const QString &profilesDir);
     
 private:
-    static Vocabulary parseVocabulary(const QJsonObject &vocabObj);
     static QJsonObject vocabularyToJson(const Vocabulary &vocab);
     static QJsonObject scoreToJson(const VocabularyScore &score);
     static VocabularyScore parseScore(const QJsonObject &scoreObj);
@@ -0,0 +1,179 @@
+#include "VocabularyQuizEngine.h"
+#include "SessionRandom.h"
+#include "EditDistance.h"
+#include "AlphabetData.h"
+#ifdef QUIZ_SQLITE_STORAGE
+#include "SqliteStore.h"
+#endif
+#include <algorithm>
+
+VocabularyQuizEngine::VocabularyQuizEngine(const DeckStore &store, std::vector<WordId> words, QObject *parent)
+    : QObject(parent), store(store), deck(std::move(words)), words(deck) {
+}
+
+void VocabularyQuizEngine::shuffle() {
+    std::shuffle(deck.begin(), deck.end(), SessionRandom::engine());
+}
+
+void VocabularyQuizEngine::start(const VocabularyQuizConfig &config) {
+    cfg = config;
+    words.clear();
+    words.reserve(deck.size());
+    // A word with no kana reading cannot be answered in kana
+    const AnswerMatcher &answers = store.answers();
+    for (WordId id : deck)
+        if (!cfg.expectKana || !answers.kana(id).isEmpty()) words.push_back(id);
+    index = 0;
+    correctRomaji = incorrectRomaji = 0;
+    correctEnglish = incorrectEnglish = 0;
+    correctKana = incorrectKana = 0;
+    hints = 0;
+    missed.clear();
+}
+
+VocabularyQuizEngine::AnswerParts VocabularyQuizEngine::splitAnswer(const VocabularyQuizConfig &config, QStringView input) {
+    input = input.trimmed();
+    AnswerParts parts{input, input};
+    if (config.expectRomaji && config.expectEnglish) {
+        qsizetype comma = input.indexOf(u',');
+        if (comma >= 0) {
+            parts.romaji = input.left(comma).trimmed();
+            QStringView rest = input.mid(comma + 1);
+            parts.english = rest.contains(u',') ? parts.romaji : rest.trimmed();
+        }
+    }
+    return parts;
+}
+
+bool VocabularyQuizEngine::check(AnswerMatcher::Kind kind, QStringView input, bool &typo) const {
+    typo = false;
+    WordId id = words[index];
+    const AnswerMatcher &answers = store.answers();
+    if (answers.matches(id, kind, input)) return true;
+    if (cfg.typoMaxEdits <= 0) return false;
+    input = input.trimmed();
+    for (int i = 0, n = answers.alternativeCount(id, kind); i < n; ++i) {
+        QStringView alt = answers.alternative(id, kind, i);
+        if (alt.size() < cfg.typoMinLength) continue;
+        if (EditDistance::bounded(alt, input, cfg.typoMaxEdits) <= cfg.typoMaxEdits) {
+            typo = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+QString VocabularyQuizEngine::foldKana(QStringView kana) {
+    QString folded;
+    folded.reserve(kana.size());
+    for (QChar c : kana) {
+        if (!c.isLetterOrNumber()) continue;
+        const char16_t u = c.unicode();
+        folded += u >= u'ァ' && u <= u'ヶ' ? QChar(char16_t(u - 0x60)) : c;
+    }
+    return folded;
+}
+
+AnswerTrie::Progress VocabularyQuizEngine::liveProgress(QStringView input) const {
+    using Progress = AnswerTrie::Progress;
+    if (finished()) return Progress::Mismatch;
+    WordId id = words[index];
+    const AnswerMatcher &answers = store.answers();
+    if (cfg.expectKana) {
+        input = input.trimmed();
+        qsizetype kana = input.size();
+        while (kana > 0 && input[kana - 1].unicode() < 0x80) --kana;
+        const QString expected = foldKana(answers.kana(id));
+        const QString typed = foldKana(input.first(kana));
+        if (!expected.isEmpty() && AlphabetData::sameReading(expected, typed))
+            return kana == input.size() ? Progress::UniqueComplete : Progress::Mismatch;
+        if (typed.size() < expected.size() && AlphabetData::sameReading(QStringView(expected).first(typed.size()), typed))
+            return Progress::Prefix;
+        return Progress::Mismatch;
+    }
+    if (!(cfg.expectRomaji && cfg.expectEnglish)) {
+        return answers.progress(id, cfg.expectRomaji ? AnswerMatcher::Romaji : AnswerMatcher::English, input);
+    }
+    qsizetype comma = input.indexOf(u',');
+    if (comma < 0) {
+        // Still typing the romaji; wait for the English part before submitting
+        Progress romaji = answers.progress(id, AnswerMatcher::Romaji, input);
+        return romaji == Progress::Mismatch ? romaji : Progress::Prefix;
+    }
+    Progress romaji = answers.progress(id, AnswerMatcher::Romaji, input.left(comma).trimmed());
+    if (romaji != Progress::Complete && romaji != Progress::UniqueComplete) return Progress::Mismatch;
+    return answers.progress(id, AnswerMatcher::English, input.mid(comma + 1));
+}
+
+VocabularyQuizEngine::AnswerResult VocabularyQuizEngine::answer(const QString &input) {
+    AnswerResult result;
+    // Views into `input` only; the matcher ignores case and spacing
+    if (finished() || QStringView(input).trimmed().isEmpty()) return result;
+    DeckStore::WordView word = currentWord();
+
+    if (cfg.expectKana) {
+        result.checkedKana = true;
+        const QString expected = foldKana(store.answers().kana(word.id()));
+        result.kanaCorrect = !expected.isEmpty() && AlphabetData::sameReading(expected, foldKana(input));
+        if (result.kanaCorrect) correctKana++;
+        else incorrectKana++;
+        if (!result.correct()) missed[word.id()]++;
+        emit answered(result);
+        return result;
+    }
+    AnswerParts parts = splitAnswer(cfg, input);
+    if (cfg.expectRomaji) {
+        result.checkedRomaji = true;
+        result.romajiCorrect = check(AnswerMatcher::Romaji, parts.romaji, result.romajiTypo);
+        if (result.romajiCorrect) correctRomaji++;
+        else incorrectRomaji++;
+    }
+    if (cfg.expectEnglish) {
+        result.checkedEnglish = true;
+        result.englishCorrect = check(AnswerMatcher::English, parts.english, result.englishTypo);
+        if (result.englishCorrect) correctEnglish++;
+        else incorrectEnglish++;
+    }
+    if (!result.correct()) missed[word.id()]++;
+    emit answered(result);
+    return result;
+}
+
+void VocabularyQuizEngine::advance() {
+    if (!finished()) ++index;
+}
+
+bool VocabularyQuizEngine::useHint() {
+    DeckStore::WordView word = currentWord();
+    if (!word.isValid() || word.hint().isEmpty()) return false;
+    hints++;
+    return true;
+}
+
+double VocabularyQuizEngine::romajiPercent() const {
+    int total = correctRomaji + incorrectRomaji;
+    return cfg.expectRomaji && total > 0 ? (double(correctRomaji) / total) * 100.0 : 0.0;
+}
+
+double VocabularyQuizEngine::englishPercent() const {
+    int total = correctEnglish + incorrectEnglish;
+    return cfg.expectEnglish && total > 0 ? (double(correctEnglish) / total) * 100.0 : 0.0;
+}
+
+void VocabularyQuizEngine::saveScores(const QString &scoresFilePath, const QString &vocabularyName) const {
+    // "All Vocabularies" is a mix, not a vocabulary with its own best score
+    if (vocabularyName.isEmpty() || vocabularyName == "All Vocabularies" || cfg.expectKana) return;
+    // The file holds only this profile's scores; rewrite it only on a new best
+    ProfileScores profileScores;
+    VocabularyData::loadProfileScores(scoresFilePath, profileScores);
+    if (VocabularyData::updateProfileVocabularyScore(profileScores, vocabularyName, romajiPercent(), englishPercent()))
+        VocabularyData::saveProfileScores(scoresFilePath, profileScores);
+}
+
+#ifdef QUIZ_SQLITE_STORAGE
+// Same rules, but a single-row upsert that keeps the better of old and new.
+void VocabularyQuizEngine::saveScores(SqliteStore &db, const QString &profileName, const QString &vocabularyName) const {
+    if (vocabularyName.isEmpty() || vocabularyName == "All Vocabularies" || cfg.expectKana) return;
+    db.updateDeckScore(profileName, vocabularyName, romajiPercent(), englishPercent());
+}
+#endif
@@ -0,0 +1,131 @@
+#ifndef VOCABULARYQUIZENGINE_H
+#define VOCABULARYQUIZENGINE_H
+#include <QObject>
+#include <QString>
+#include <QStringView>
+#include <map>
+#include <vector>
+#include "DeckStore.h"
+
+#ifdef QUIZ_SQLITE_STORAGE
+class SqliteStore;
+#endif
+
+struct VocabularyQuizConfig {
+    bool expectRomaji = true;
+    bool expectEnglish = true;
+    // An answer within typoMaxEdits edits of an alternative of at least
+    // typoMinLength characters counts as correct with a typo; 0 turns this off.
+    int typoMaxEdits = 1;
+    int typoMinLength = 6;
+    // Reverse quiz: the English is shown and the reading typed in kana.
+    // Replaces the romaji and English answers; words without kana are left out.
+    bool expectKana = false;
+};
+
+// Widget-free vocabulary quiz session over a set of DeckStore words: word
+// order, answer checking, scoring and best-score persistence. Answers are "romaji", "english" or
+// "romaji, english" depending on the config, or the word's kana in reverse.
+class VocabularyQuizEngine : public QObject {
+    Q_OBJECT
+public:
+    struct AnswerResult {
+        bool checkedRomaji = false;
+        bool romajiCorrect = false;
+        bool checkedEnglish = false;
+        bool englishCorrect = false;
+        bool checkedKana = false;
+        bool kanaCorrect = false;
+        // Accepted, but only within the typo tolerance
+        bool romajiTypo = false;
+        bool englishTypo = false;
+        bool correct() const {
+            return (checkedRomaji || checkedEnglish || checkedKana)
+                && (!checkedRomaji || romajiCorrect) && (!checkedEnglish || englishCorrect)
+                && (!checkedKana || kanaCorrect);
+        }
+        bool hadTypo() const { return romajiTypo || englishTypo; }
+    };
+    struct AnswerParts {
+        QStringView romaji;
+        QStringView english;
+    };
+
+    // `store` must outlive the engine.
+    VocabularyQuizEngine(const DeckStore &store, std::vector<WordId> words, QObject *parent = nullptr);
+
+    // Shuffles the words; the order holds until the next shuffle and
+    // applies from the next start().
+    void shuffle();
+    // Starts a session from the first word with cleared statistics. The
+    // session asks every word the config can check.
+    void start(const VocabularyQuizConfig &config);
+    const VocabularyQuizConfig &config() const { return cfg; }
+
+    bool finished() const { return index >= words.size(); }
+    // Invalid once the session is finished.
+    DeckStore::WordView currentWord() const { return finished() ? DeckStore::WordView() : store.word(words[index]); }
+    const DeckStore &deckStore() const { return store; }
+    int currentIndex() const { return static_cast<int>(index); }
+    int wordCount() const { return static_cast<int>(words.size()); }
+    // Words the config leaves out of this session (no kana to type).
+    int skippedWordCount() const { return static_cast<int>(deck.size() - words.size()); }
+    // Checks input against the current word's precomputed answers (see
+    // AnswerMatcher) and records the outcome. Does not advance.
+    AnswerResult answer(const QString &input);
+    void advance();
+    // Live feedback for partly typed input. In "romaji, english" mode the
+    // romaji must be complete once the comma is typed; only a unique
+    // complete English part (or single answer) reports UniqueComplete.
+    // Kana input may end in romaji that is still being converted.
+    AnswerTrie::Progress liveProgress(QStringView input) const;
+    // Splits input the way answer() reads it: "romaji, english" when both are
+    // expected (a single part is tried for both), else the whole input.
+    static AnswerParts splitAnswer(const VocabularyQuizConfig &config, QStringView input);
+    // Counts a hint use; false if the current word has none.
+    bool useHint();
+
+    int correctRomajiCount() const { return correctRomaji; }
+    int incorrectRomajiCount() const { return incorrectRomaji; }
+    int correctEnglishCount() const { return correctEnglish; }
+    int incorrectEnglishCount() const { return incorrectEnglish; }
+    int correctKanaCount() const { return correctKana; }
+    int incorrectKanaCount() const { return incorrectKana; }
+    int hintCount() const { return hints; }
+    const std::map<WordId, int> &incorrectWords() const { return missed; }
+    double romajiPercent() const;
+    double englishPercent() const;
+    // Records this session's percentages as best scores if they beat the stored
+    // ones. `scoresFilePath` is the profile's own scores file. Kana sessions
+    // have no best score of their own and are not recorded.
+    void saveScores(const QString &scoresFilePath, const QString &vocabularyName) const;
+#ifdef QUIZ_SQLITE_STORAGE
+    void saveScores(SqliteStore &db, const QString &profileName, const QString &vocabularyName) const;
+#endif
+
+signals:
+    void answered(const VocabularyQuizEngine::AnswerResult &result);
+
+private:
+    // Exact match, else a near miss within the typo tolerance.
+    bool check(AnswerMatcher::Kind kind, QStringView input, bool &typo) const;
+    // Kana compared the way the reverse quiz reads it: without spaces or
+    // punctuation, katakana as hiragana, and kana read alike (じ, ぢ) as equal.
+    static QString foldKana(QStringView kana);
+
+    const DeckStore &store;
+    std::vector<WordId> deck;  // every word given, in shuffled order
+    std::vector<WordId> words; // the words this session asks
+    std::size_t index = 0;
+    VocabularyQuizConfig cfg;
+    int correctRomaji = 0;
+    int incorrectRomaji = 0;
+    int correctEnglish = 0;
+    int incorrectEnglish = 0;
+    int correctKana = 0;
+    int incorrectKana = 0;
+    int hints = 0;
+    std::map<WordId, int> missed; // incorrect attempts per word
+};
+
+#endif // VOCABULARYQUIZENGINE_H
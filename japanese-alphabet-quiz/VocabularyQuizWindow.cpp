@@ -1,58 +1,34 @@
 #include "VocabularyQuizWindow.h"
 #include "VocabularyResultsDialog.h"
 #include "FeedbackDialog.h"
+#include "EditDistance.h"
+#include "SrsScheduler.h"
+#ifdef QUIZ_SQLITE_STORAGE
+#include "SqliteStore.h"
+#endif
 #include <QFont>
 #include <QApplication>
+#include <QDateTime>
 #include <QMessageBox>
 #include <QIcon>
 #include <algorithm>
-#include <random>
 #include <cstddef>
-#include <QFile>
-#include <QDir>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonParseError>
-
-VocabularyQuizWindow::VocabularyQuizWindow(const std::vector<VocabularyWord> &words, const QString &profileName, const QString &vocabularyName, const QString &scoresFilePath, const int messageDuration,QWidget *parent)
-    : QWidget(parent), vocabularyWords(words), currentWordIndex(0),
-      expectingRomaji(true), expectingEnglish(false),
-      correctRomajiCount(0), incorrectRomajiCount(0),
-      correctEnglishCount(0), incorrectEnglishCount(0), hintCount(0),
+
+VocabularyQuizWindow::VocabularyQuizWindow(const DeckStore &store, const std::vector<WordId> &words, ProfileStore *profile, const QString &profileName, const QString &vocabularyName, const QString &scoresFilePath, const int messageDuration,QWidget *parent)
+    : QWidget(parent), engine(store, words), profile(profile),
       profileName(profileName), vocabularyName(vocabularyName),
       scoresFilePath(scoresFilePath), quizStarted(false), messageDuration(messageDuration) {
 
-    // Load preferences from profile JSON
-    QFile profileFile(QDir::currentPath() + "/profiles/" + profileName + ".json");
-    if (profileFile.open(QIODevice::ReadOnly)) {
-        QByteArray data = profileFile.readAll();
-        profileFile.close();
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-        if (parseError.error == QJsonParseError::NoError && doc.isObject()) {
-            QJsonObject obj = doc.object();
-
-            // Load showCommentsOnCorrect
-            if (obj.contains("showCommentsOnCorrect") && obj["showCommentsOnCorrect"].isBool()) {
-                showCommentsOnCorrect = obj["showCommentsOnCorrect"].toBool();
-            }
-
-            // Load expectRomaji (default true)
-            if (obj.contains("expectRomaji") && obj["expectRomaji"].isBool()) {
-                initialExpectRomaji = obj["expectRomaji"].toBool();
-            }
-
-            // Load expectEnglish (default true)
-            if (obj.contains("expectEnglish") && obj["expectEnglish"].isBool()) {
-                initialExpectEnglish = obj["expectEnglish"].toBool();
-            }
-        }
-    }
+    // Load preferences from the profile
+    showCommentsOnCorrect = profile->boolValue("showCommentsOnCorrect", true);
+    initialExpectRomaji = profile->boolValue("expectRomaji", true);
+    initialExpectEnglish = profile->boolValue("expectEnglish", true);
+    initialExpectKana = profile->boolValue("expectKana", false);
+    acceptTypos = profile->boolValue("acceptTypos", true);
+    liveFeedback = profile->boolValue("liveFeedback", false);
 
     // Shuffle the words for random order
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(vocabularyWords.begin(), vocabularyWords.end(), g);
+    engine.shuffle();
 
     setupUI();
 }
@@ -100,9 +76,15 @@ void VocabularyQuizWindow::setupUI() {
     englishCheckbox = new QCheckBox("English", this);
     romajiCheckbox->setChecked(initialExpectRomaji);
     englishCheckbox->setChecked(initialExpectEnglish);
+    // Reverse: the English is shown and the kana typed, converted from romaji
+    kanaCheckbox = new QCheckBox("Kana from English", this);
+    kanaCheckbox->setChecked(initialExpectKana);
+    romajiCheckbox->setEnabled(!initialExpectKana);
+    englishCheckbox->setEnabled(!initialExpectKana);
 
     checkboxLayout->addWidget(romajiCheckbox);
     checkboxLayout->addWidget(englishCheckbox);
+    checkboxLayout->addWidget(kanaCheckbox);
     checkboxLayout->addStretch();
 
     mainLayout->addLayout(checkboxLayout);
@@ -143,6 +125,7 @@ void VocabularyQuizWindow::setupUI() {
     answerInput->setPlaceholderText("Enter your answer...");
     answerInput->setStyleSheet("font-size: 16px; padding: 8px;");
     answerInput->hide();
+    kanaInput = new KanaInput(answerInput);
     mainLayout->addWidget(answerInput);
     // Event filter to allow early dismissal of messages when typing
     answerInput->installEventFilter(this);
@@ -225,10 +208,12 @@ void VocabularyQuizWindow::setupUI() {
     // Connect signals
     connect(romajiCheckbox, &QCheckBox::checkStateChanged, this, &VocabularyQuizWindow::onRomajiCheckboxChanged);
     connect(englishCheckbox, &QCheckBox::checkStateChanged, this, &VocabularyQuizWindow::onEnglishCheckboxChanged);
+    connect(kanaCheckbox, &QCheckBox::checkStateChanged, this, &VocabularyQuizWindow::onKanaCheckboxChanged);
     connect(startButton, &QPushButton::clicked, this, &VocabularyQuizWindow::onStartClicked);
     connect(checkButton, &QPushButton::clicked, this, &VocabularyQuizWindow::onCheckAnswer);
     connect(hintButton, &QPushButton::clicked, this, &VocabularyQuizWindow::onHintClicked);
     connect(answerInput, &QLineEdit::returnPressed, this, &VocabularyQuizWindow::onCheckAnswer);
+    connect(kanaInput, &KanaInput::edited, this, &VocabularyQuizWindow::onAnswerEdited);
     connect(backButton, &QPushButton::clicked, this, &QWidget::close);
 
     // Settings menu
@@ -238,72 +223,41 @@ void VocabularyQuizWindow::setupUI() {
     toggleCommentsAction->setChecked(showCommentsOnCorrect);
     connect(toggleCommentsAction, &QAction::toggled, this, [this](bool checked){
         showCommentsOnCorrect = checked;
-        // Persist immediately to profile JSON
-        QFile profileFile(QDir::currentPath() + "/profiles/" + profileName + ".json");
-        QJsonObject obj;
-        if (profileFile.open(QIODevice::ReadOnly)) {
-            QByteArray data = profileFile.readAll();
-            profileFile.close();
-            QJsonParseError parseError;
-            QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-            if (parseError.error == QJsonParseError::NoError && doc.isObject()) {
-                obj = doc.object();
-            }
-        }
-        obj["showCommentsOnCorrect"] = checked;
-        if (profileFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            QJsonDocument outDoc(obj);
-            profileFile.write(outDoc.toJson(QJsonDocument::Indented));
-            profileFile.close();
-        }
+        this->profile->setValue("showCommentsOnCorrect", checked);
+    });
+    acceptTyposAction = settingsMenu->addAction("Accept one typo in answers of 6+ letters");
+    acceptTyposAction->setCheckable(true);
+    acceptTyposAction->setChecked(acceptTypos);
+    connect(acceptTyposAction, &QAction::toggled, this, [this](bool checked){
+        acceptTypos = checked;
+        this->profile->setValue("acceptTypos", checked);
+    });
+    liveFeedbackAction = settingsMenu->addAction("Live feedback while typing");
+    liveFeedbackAction->setCheckable(true);
+    liveFeedbackAction->setChecked(liveFeedback);
+    connect(liveFeedbackAction, &QAction::toggled, this, [this](bool checked){
+        liveFeedback = checked;
+        this->profile->setValue("liveFeedback", checked);
+        setAnswerBorder("");
     });
     settingsButton->setMenu(settingsMenu);
 }
 
 void VocabularyQuizWindow::onRomajiCheckboxChanged(int state) {
     updateCheckboxStates();
-
-    // Persist to profile JSON
-    QFile profileFile(QDir::currentPath() + "/profiles/" + profileName + ".json");
-    QJsonObject obj;
-    if (profileFile.open(QIODevice::ReadOnly)) {
-        QByteArray data = profileFile.readAll();
-        profileFile.close();
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-        if (parseError.error == QJsonParseError::NoError && doc.isObject()) {
-            obj = doc.object();
-        }
-    }
-    obj["expectRomaji"] = romajiCheckbox->isChecked();
-    if (profileFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        QJsonDocument outDoc(obj);
-        profileFile.write(outDoc.toJson(QJsonDocument::Indented));
-        profileFile.close();
-    }
+    profile->setValue("expectRomaji", romajiCheckbox->isChecked());
 }
 
 void VocabularyQuizWindow::onEnglishCheckboxChanged(int state) {
     updateCheckboxStates();
+    profile->setValue("expectEnglish", englishCheckbox->isChecked());
+}
 
-    // Persist to profile JSON
-    QFile profileFile(QDir::currentPath() + "/profiles/" + profileName + ".json");
-    QJsonObject obj;
-    if (profileFile.open(QIODevice::ReadOnly)) {
-        QByteArray data = profileFile.readAll();
-        profileFile.close();
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-        if (parseError.error == QJsonParseError::NoError && doc.isObject()) {
-            obj = doc.object();
-        }
-    }
-    obj["expectEnglish"] = englishCheckbox->isChecked();
-    if (profileFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        QJsonDocument outDoc(obj);
-        profileFile.write(outDoc.toJson(QJsonDocument::Indented));
-        profileFile.close();
-    }
+void VocabularyQuizWindow::onKanaCheckboxChanged(int state) {
+    // Kana answers replace the other two
+    romajiCheckbox->setEnabled(state == 0);
+    englishCheckbox->setEnabled(state == 0);
+    profile->setValue("expectKana", kanaCheckbox->isChecked());
 }
 
 void VocabularyQuizWindow::updateCheckboxStates() {
@@ -319,14 +273,20 @@ void VocabularyQuizWindow::updateCheckboxStates() {
 }
 
 void VocabularyQuizWindow::onStartClicked() {
-    expectingRomaji = romajiCheckbox->isChecked();
-    expectingEnglish = englishCheckbox->isChecked();
+    VocabularyQuizConfig config;
+    config.expectRomaji = romajiCheckbox->isChecked();
+    config.expectEnglish = englishCheckbox->isChecked();
+    config.typoMaxEdits = acceptTypos ? 1 : 0;
+    config.expectKana = kanaCheckbox->isChecked();
+    if (config.expectKana) config.expectRomaji = config.expectEnglish = false;
+    kanaInput->setActive(config.expectKana);
 
     // Hide setup UI
     // checkboxLayout->hide();
     titleLabel->hide();
     romajiCheckbox->hide();
     englishCheckbox->hide();
+    kanaCheckbox->hide();
     startButton->hide();
     instructionLabel->hide();
 
@@ -338,35 +298,39 @@ void VocabularyQuizWindow::onStartClicked() {
     scoreLabel->show();
 
     quizStarted = true;
-    currentWordIndex = 0;
-
-    // Reset statistics
-    correctRomajiCount = incorrectRomajiCount = 0;
-    correctEnglishCount = incorrectEnglishCount = 0;
-    incorrectWords.clear();
+    engine.start(config);
 
     showNextWord();
 }
 
 void VocabularyQuizWindow::showNextWord() {
-    if (currentWordIndex >= vocabularyWords.size()) {
+    if (engine.finished()) {
         showResults();
         return;
     }
 
-    const VocabularyWord &word = vocabularyWords[currentWordIndex];
-    questionLabel->setText(word.hiragana.isEmpty() ? (word.katakana.isEmpty() ? word.kanji : word.katakana) : word.hiragana);
-    answerInput->clear();
+    DeckStore::WordView word = engine.currentWord();
+    const VocabularyQuizConfig &config = engine.config();
+    if (config.expectKana) {
+        questionLabel->setText(word.english().toString());
+        kanaInput->setKatakana(word.hiragana().isEmpty());
+    } else {
+        questionLabel->setText(word.displayText().toString());
+    }
+    kanaInput->clear();
+    setAnswerBorder("");
     answerInput->setFocus();
     // (No inline labels to clear)
 
     // Enable/disable hint button based on whether the current word has a hint
-    hintButton->setEnabled(!word.hint.isEmpty());
+    hintButton->setEnabled(!word.hint().isEmpty());
 
     // Update title based on what we're expecting
-    if (expectingRomaji && expectingEnglish) {
+    if (config.expectKana) {
+        titleLabel->setText(word.hiragana().isEmpty() ? "Enter Katakana" : "Enter Hiragana");
+    } else if (config.expectRomaji && config.expectEnglish) {
         titleLabel->setText("Enter Romaji and English (separated by comma)");
-    } else if (expectingRomaji) {
+    } else if (config.expectRomaji) {
         titleLabel->setText("Enter Romaji");
     } else {
         titleLabel->setText("Enter English");
@@ -377,188 +341,121 @@ void VocabularyQuizWindow::showNextWord() {
 }
 
 void VocabularyQuizWindow::onCheckAnswer() {
-    if (currentWordIndex >= vocabularyWords.size()) return;
+    if (engine.finished()) return;
 
+    kanaInput->flush();
     QString userInput = answerInput->text().trimmed().toLower();
     if (userInput.isEmpty()) return;
 
-    const VocabularyWord &currentWord = vocabularyWords[currentWordIndex];
-    bool correct = false;
+    DeckStore::WordView currentWord = engine.currentWord();
     qDebug() << "Check Answer"; // Debug message
 
-    if (expectingRomaji && expectingEnglish) {
-        // Both romaji and english expected, separated by comma
-        if(userInput.isEmpty()) {
-            incorrectEnglishCount++;
-            incorrectRomajiCount++;
-            // "Please enter both romaji and english separated by comma",
-            showError(QString("<span style='color:#e74c3c;'>%1</span>, <span style='color:#e74c3c;'>%2</span>")
-                          .arg(currentWord.romaji, currentWord.english),
-                      currentWord.comment);
-            return;
+    VocabularyQuizEngine::AnswerResult result = engine.answer(userInput);
+#ifdef QUIZ_SQLITE_STORAGE
+    // Every attempt is kept, so "hardest words" can be asked for any period
+    if (SqliteStore *db = profile->database()) {
+        db->recordAttempt(profileName, QString("%1|%2|%3").arg(currentWord.displayText(), currentWord.romaji(), currentWord.english()),
+                          result.correct());
+    }
+#endif
+    if (srs) {
+        // A typo still counts as recalled, but with effort
+        SrsScheduler::Grade grade = !result.correct() ? SrsScheduler::Grade::Again
+                                    : result.hadTypo() ? SrsScheduler::Grade::Hard
+                                                       : SrsScheduler::Grade::Good;
+        srs->review(SrsScheduler::wordKey(currentWord), grade, QDateTime::currentSecsSinceEpoch());
+    }
+    VocabularyQuizEngine::AnswerParts typed = VocabularyQuizEngine::splitAnswer(engine.config(), userInput);
+    if (result.correct()) {
+        if (result.hadTypo()) {
+            // Accepted, but show where the spelling was off
+            QString correction = "Correct, but check the spelling ✅";
+            if (result.romajiTypo) correction += "<br>Romaji: " + highlightedAnswer(currentWord.romaji(), typed.romaji);
+            if (result.englishTypo) correction += "<br>English: " + highlightedAnswer(currentWord.english(), typed.english);
+            showTypoCorrection(correction, showCommentsOnCorrect ? currentWord.comment().toString() : QString());
+        } else if(!currentWord.comment().isEmpty() && showCommentsOnCorrect) {
+            showComment(currentWord.comment().toString()); // advances after dismissal
         } else {
-            QStringList parts = userInput.split(',');
-            QString userRomaji, userEnglish;
-            if (parts.size() == 2) {
-                userRomaji = parts[0].trimmed();
-                userEnglish = parts[1].trimmed();
-            } else {
-                userRomaji = parts[0].trimmed();
-                userEnglish = parts[0].trimmed();
-            }
-            bool romajiCorrect = false;
-            bool englishCorrect = false;
-
-            QStringList romajiParts = currentWord.romaji.toLower().split(" / ");
-            for (const QString &part : romajiParts) {
-                if (part.trimmed() == userRomaji) {
-                    romajiCorrect = true;
-                    break;
-                }
-            }
-
-            QStringList englishParts = currentWord.english.toLower().split(" / ");
-            for (const QString &part : englishParts) {
-                if (part.trimmed() == userEnglish) {
-                    englishCorrect = true;
-                    break;
-                }
-            }
-
-            if (romajiCorrect) correctRomajiCount++;
-            else incorrectRomajiCount++;
-
-            if (englishCorrect) correctEnglishCount++;
-            else incorrectEnglishCount++;
-
-            if (romajiCorrect && englishCorrect) {
-              correct = true;
-            } else {
-                QString errorMsg;
-                if (!romajiCorrect && !englishCorrect) {
-                    errorMsg = QString("Correct: <span style='color:#e74c3c;'>%1</span>, <span style='color:#e74c3c;'>%2</span>")
-                                   .arg(currentWord.romaji, currentWord.english);
-                } else if (!romajiCorrect) {
-                    errorMsg = QString("Romaji should be: <span style='color:#e74c3c;'>%1</span>").arg(currentWord.romaji);
-                } else {
-                    errorMsg = QString("English should be: <span style='color:#e74c3c;'>%1</span>").arg(currentWord.english);
-                }
-                showError(errorMsg, currentWord.comment);
-            }
+            engine.advance();
+            QTimer::singleShot(200, this, &VocabularyQuizWindow::showNextWord);
         }
-    } else if (expectingRomaji) {
-        checkRomajiAnswer();
-        return;
-    } else if (expectingEnglish) {
-        checkEnglishAnswer();
         return;
     }
 
-    if (correct) {
-                if(!currentWord.comment.isEmpty() && showCommentsOnCorrect) {
-                    showComment(currentWord.comment); // increments index after dismissal
-                } else {
-                    currentWordIndex++;
-                    QTimer::singleShot(200, this, &VocabularyQuizWindow::showNextWord);
-                }
+    // Characters typed wrong or left out are shown in red
+    QString errorMsg;
+    if (result.checkedRomaji && result.checkedEnglish) {
+        if (!result.romajiCorrect && !result.englishCorrect) {
+            errorMsg = QString("Correct: %1, %2")
+                           .arg(highlightedAnswer(currentWord.romaji(), typed.romaji),
+                                highlightedAnswer(currentWord.english(), typed.english));
+        } else if (!result.romajiCorrect) {
+            errorMsg = QString("Romaji should be: %1").arg(highlightedAnswer(currentWord.romaji(), typed.romaji));
+        } else {
+            errorMsg = QString("English should be: %1").arg(highlightedAnswer(currentWord.english(), typed.english));
+        }
+    } else if (result.checkedKana) {
+        QStringView kana = currentWord.hiragana().isEmpty() ? currentWord.katakana() : currentWord.hiragana();
+        errorMsg = "Correct kana: " + highlightedAnswer(kana, userInput);
+    } else if (result.checkedRomaji) {
+        errorMsg = "Correct romaji: " + highlightedAnswer(currentWord.romaji(), typed.romaji);
     } else {
-        incorrectWords[const_cast<VocabularyWord*>(&currentWord)]++;
+        errorMsg = "Correct English: " + highlightedAnswer(currentWord.english(), typed.english);
     }
+    showError(errorMsg, currentWord.comment().toString());
 }
 
-void VocabularyQuizWindow::onHintClicked() {
-    if (currentWordIndex >= vocabularyWords.size()) return;
-
-    const VocabularyWord &currentWord = vocabularyWords[currentWordIndex];
-
-    // Check if the current word has a hint
-    if (currentWord.hint.isEmpty()) {
-        return; // Button should be disabled, but just in case
+void VocabularyQuizWindow::onAnswerEdited(const QString &text) {
+    if (!liveFeedback || engine.finished()) return;
+    switch (engine.liveProgress(text)) {
+    case AnswerTrie::Progress::Mismatch:
+        setAnswerBorder("#e74c3c");
+        break;
+    case AnswerTrie::Progress::Prefix:
+        setAnswerBorder("");
+        break;
+    case AnswerTrie::Progress::Complete:
+        setAnswerBorder("#27ae60");
+        break;
+    case AnswerTrie::Progress::UniqueComplete:
+        setAnswerBorder("#27ae60");
+        // Submit once the edit has been delivered, unless Enter got there first
+        QTimer::singleShot(0, this, [this]() {
+            if (!engine.finished() && engine.liveProgress(answerInput->text()) == AnswerTrie::Progress::UniqueComplete)
+                onCheckAnswer();
+        });
+        break;
     }
+}
 
-    // Increment hint counter
-    hintCount++;
+// Restyling is the costly part of a keystroke; only do it on a change
+void VocabularyQuizWindow::setAnswerBorder(const QString &color) {
+    if (color == answerBorderColor) return;
+    answerBorderColor = color;
+    QString style = "font-size: 16px; padding: 8px;";
+    if (!color.isEmpty()) style += QString(" border: 2px solid %1;").arg(color);
+    answerInput->setStyleSheet(style);
+}
+
+void VocabularyQuizWindow::onHintClicked() {
+    // Counts the hint; false if there is none (button should be disabled, but just in case)
+    if (!engine.useHint()) return;
+    DeckStore::WordView currentWord = engine.currentWord();
 
     // Show hint dialog
     QMessageBox hintDialog;
     hintDialog.setWindowTitle("Hint");
-    hintDialog.setText(currentWord.hint);
+    hintDialog.setText(currentWord.hint().toString());
     hintDialog.setIcon(QMessageBox::Information);
     hintDialog.setStandardButtons(QMessageBox::Ok);
     hintDialog.exec();
 }
 
-void VocabularyQuizWindow::checkRomajiAnswer() {
-    const VocabularyWord &currentWord = vocabularyWords[currentWordIndex];
-    QString userInput = answerInput->text().trimmed().toLower();
-    bool romajiCorrect = false;
-
-    QStringList romajiParts = currentWord.romaji.toLower().split(" / ");
-    for (const QString &part : romajiParts) {
-        if (part.trimmed() == userInput) {
-            romajiCorrect = true;
-            break;
-        }
-    }
-
-    if (romajiCorrect) {
-        correctRomajiCount++;
-        if(!currentWord.comment.isEmpty() && showCommentsOnCorrect) {
-            showComment(currentWord.comment); // increments index after dismissal
-        } else {
-            currentWordIndex++;
-            QTimer::singleShot(200, this, &VocabularyQuizWindow::showNextWord);
-        }
-    } else {
-        incorrectRomajiCount++;
-        incorrectWords[const_cast<VocabularyWord*>(&currentWord)]++;
-
-        // Highlight incorrect characters in red
-        QString errorMsg = "Correct romaji: ";
-        for (int i = 0; i < romajiParts.length(); ++i) {
-            if (i < userInput.length() && userInput[i] == romajiParts[i]) {
-                errorMsg += romajiParts[i];
-            } else {
-                errorMsg += QString("<span style='color: red;'>%1</span>").arg(romajiParts[i]);
-            }
-        }
-        showError(errorMsg, currentWord.comment);
-    }
-}
-
-void VocabularyQuizWindow::checkEnglishAnswer() {
-    const VocabularyWord &currentWord = vocabularyWords[currentWordIndex];
-    QString userInput = answerInput->text().trimmed().toLower();
-    bool englishCorrect = false;
-
-    QStringList englishParts = currentWord.english.toLower().split(" / ");
-    for (const QString &part : englishParts) {
-        if (part.trimmed() == userInput) {
-            englishCorrect = true;
-            break;
-        }
-    }
-
-    if (englishCorrect) {
-        correctEnglishCount++;
-        if(!currentWord.comment.isEmpty() && showCommentsOnCorrect) {
-            showComment(currentWord.comment); // increments index after dismissal
-        } else {
-            currentWordIndex++;
-            QTimer::singleShot(200, this, &VocabularyQuizWindow::showNextWord);
-        }
-    } else {
-        incorrectEnglishCount++;
-        incorrectWords[const_cast<VocabularyWord*>(&currentWord)]++;
-        showError(QString("Correct English: <span style='color: red;'>%1</span>").arg(currentWord.english), currentWord.comment);
-    }
-}
-
 void VocabularyQuizWindow::showComment(const QString &comment) {
     QString primary = QString("Correct ✅");
     FeedbackDialog dlg(primary, comment, messageDuration, this);
     dlg.exec();
-    currentWordIndex++; // advance once after dialog dismissed or auto-closed
+    engine.advance(); // advance once after dialog dismissed or auto-closed
     showNextWord();
 }
 
@@ -568,10 +465,51 @@ void VocabularyQuizWindow::showError(const QString &correctAnswer, const QString
                            : correctAnswer;
     FeedbackDialog dlg(primary, comment, messageDuration, this);
     dlg.exec();
-    currentWordIndex++; // advance once after dialog dismissed or auto-closed
+    engine.advance(); // advance once after dialog dismissed or auto-closed
     showNextWord();
 }
 
+void VocabularyQuizWindow::showTypoCorrection(const QString &correction, const QString &comment) {
+    FeedbackDialog dlg(correction, comment, messageDuration, this);
+    dlg.exec();
+    engine.advance(); // advance once after dialog dismissed or auto-closed
+    showNextWord();
+}
+
+// The expected field as HTML. The alternative closest to what was typed is
+// aligned against it character by character; its wrong or missing
+// characters are red. Other alternatives are listed as they are.
+QString VocabularyQuizWindow::highlightedAnswer(QStringView expected, QStringView typed) {
+    QList<QStringView> alternatives = expected.split(u" / ");
+    qsizetype closest = 0;
+    int closestEdits = -1;
+    for (qsizetype i = 0; i < alternatives.size(); ++i) {
+        QStringView alt = alternatives[i].trimmed();
+        int cap = int(std::max(alt.size(), typed.size()));
+        int edits = EditDistance::bounded(alt, typed, cap);
+        if (closestEdits < 0 || edits < closestEdits) {
+            closest = i;
+            closestEdits = edits;
+        }
+    }
+    QStringList rendered;
+    for (qsizetype i = 0; i < alternatives.size(); ++i) {
+        QStringView alt = alternatives[i].trimmed();
+        if (i != closest) {
+            rendered << alt.toString().toHtmlEscaped();
+            continue;
+        }
+        QString html;
+        for (const EditDistance::Step &step : EditDistance::diff(alt, typed)) {
+            if (step.op == EditDistance::Op::Extra) continue;
+            QString ch = QString(alt[step.expectedIndex]).toHtmlEscaped();
+            html += step.op == EditDistance::Op::Equal ? ch : QString("<span style='color:#e74c3c;'>%1</span>").arg(ch);
+        }
+        rendered << html;
+    }
+    return rendered.join(" / ");
+}
+
 void VocabularyQuizWindow::hideErrorMessage() {
     // (No inline labels)
 }
@@ -585,59 +523,52 @@ void VocabularyQuizWindow::onMessageTimeout() {
 }
 
 void VocabularyQuizWindow::updateScore() {
-    QString scoreText = QString("Progress: %1/%2").arg(currentWordIndex + 1).arg(vocabularyWords.size());
+    QString scoreText = QString("Progress: %1/%2").arg(engine.currentIndex() + 1).arg(engine.wordCount());
 
-    if (expectingRomaji || expectingEnglish) {
+    const VocabularyQuizConfig &config = engine.config();
+    if (config.expectRomaji || config.expectEnglish) {
         scoreText += " | ";
-        if (expectingRomaji) {
-            scoreText += QString("Romaji - Correct: %1, Incorrect: %2").arg(correctRomajiCount).arg(incorrectRomajiCount);
+        if (config.expectRomaji) {
+            scoreText += QString("Romaji - Correct: %1, Incorrect: %2").arg(engine.correctRomajiCount()).arg(engine.incorrectRomajiCount());
         }
-        if (expectingEnglish) {
-            if (expectingRomaji) scoreText += " | ";
-            scoreText += QString("English - Correct: %1, Incorrect: %2").arg(correctEnglishCount).arg(incorrectEnglishCount);
+        if (config.expectEnglish) {
+            if (config.expectRomaji) scoreText += " | ";
+            scoreText += QString("English - Correct: %1, Incorrect: %2").arg(engine.correctEnglishCount()).arg(engine.incorrectEnglishCount());
         }
+    } else if (config.expectKana) {
+        scoreText += QString(" | Kana - Correct: %1, Incorrect: %2").arg(engine.correctKanaCount()).arg(engine.incorrectKanaCount());
+        if (engine.skippedWordCount() > 0)
+            scoreText += QString(" | %1 without kana not asked").arg(engine.skippedWordCount());
     }
 
     scoreLabel->setText(scoreText);
 }
 
 void VocabularyQuizWindow::showResults() {
-    // Calculate percentages
-    double romajiPercent = 0.0;
-    double englishPercent = 0.0;
-
-    if (expectingRomaji) {
-        int totalRomaji = correctRomajiCount + incorrectRomajiCount;
-        if (totalRomaji > 0) {
-            romajiPercent = (double(correctRomajiCount) / totalRomaji) * 100.0;
-        }
-    }
-
-    if (expectingEnglish) {
-        int totalEnglish = correctEnglishCount + incorrectEnglishCount;
-        if (totalEnglish > 0) {
-            englishPercent = (double(correctEnglishCount) / totalEnglish) * 100.0;
-        }
-    }
-
-    // Save scores if we have a vocabulary name (not "All Vocabularies")
-    if (!vocabularyName.isEmpty() && vocabularyName != "All Vocabularies") {
-        ProfileScores profileScores;
-        VocabularyData::loadProfileScores(scoresFilePath, profileScores);
-        VocabularyData::updateProfileVocabularyScore(profileScores, profileName, vocabularyName, romajiPercent, englishPercent);
-        VocabularyData::saveProfileScores(scoresFilePath, profileScores);
+    // Save best scores for this vocabulary
+    bool savedToDatabase = false;
+#ifdef QUIZ_SQLITE_STORAGE
+    if (SqliteStore *db = profile->database()) {
+        engine.saveScores(*db, profileName, vocabularyName);
+        savedToDatabase = true;
     }
+#endif
+    if (!savedToDatabase) engine.saveScores(scoresFilePath, vocabularyName);
 
     // Show results dialog
     VocabularyResultsDialog resultsDialog(
-        expectingRomaji,
-        expectingEnglish,
-        correctRomajiCount,
-        incorrectRomajiCount,
-        correctEnglishCount,
-        incorrectEnglishCount,
-        hintCount,
-        incorrectWords,
+        engine.config().expectRomaji,
+        engine.config().expectEnglish,
+        engine.correctRomajiCount(),
+        engine.incorrectRomajiCount(),
+        engine.correctEnglishCount(),
+        engine.incorrectEnglishCount(),
+        engine.config().expectKana,
+        engine.correctKanaCount(),
+        engine.incorrectKanaCount(),
+        engine.hintCount(),
+        engine.deckStore(),
+        engine.incorrectWords(),
         this
     );
 
@@ -663,6 +594,8 @@ void VocabularyQuizWindow::resetQuiz() {
     // Reset all UI to initial state
     questionLabel->hide();
     answerInput->hide();
+    kanaInput->clear();
+    kanaInput->setActive(engine.config().expectKana);
     checkButton->hide();
     hintButton->hide();
     scoreLabel->hide();
@@ -675,22 +608,15 @@ void VocabularyQuizWindow::resetQuiz() {
     instructionLabel->show();
     romajiCheckbox->show();
     englishCheckbox->show();
+    kanaCheckbox->show();
     startButton->show();
 
-    // Reset quiz state
+    // Reset quiz state and statistics
     quizStarted = false;
-    currentWordIndex = 0;
-
-    // Reset statistics
-    correctRomajiCount = incorrectRomajiCount = 0;
-    correctEnglishCount = incorrectEnglishCount = 0;
-    hintCount = 0;
-    incorrectWords.clear();
+    engine.start(engine.config());
 
     // Shuffle words again for new quiz
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(vocabularyWords.begin(), vocabularyWords.end(), g);
+    engine.shuffle();
 }
 
 bool VocabularyQuizWindow::eventFilter(QObject *obj, QEvent *event) {
@@ -14,14 +14,21 @@
 #include <QMenu>
 #include <map>
 #include "VocabularyData.h"
+#include "VocabularyQuizEngine.h"
+#include "KanaInput.h"
+#include "ProfileStore.h"
+
+class SrsScheduler;
 
 class VocabularyQuizWindow : public QWidget {
     Q_OBJECT
 
 public:
-    explicit VocabularyQuizWindow(const std::vector<VocabularyWord> &words, const QString &profileName, const QString &vocabularyName, const QString &scoresFilePath, int messageDuration = 2, QWidget *parent = nullptr);
+    explicit VocabularyQuizWindow(const DeckStore &store, const std::vector<WordId> &words, ProfileStore *profile, const QString &profileName, const QString &vocabularyName, const QString &scoresFilePath, int messageDuration = 2, QWidget *parent = nullptr);
     void setShowCommentsOnCorrect(bool enabled) { showCommentsOnCorrect = enabled; }
     void resetQuiz();
+    // Every answer is also graded into `scheduler` (may be null); it must outlive the window.
+    void setScheduler(SrsScheduler *scheduler) { srs = scheduler; }
 
 signals:
     void quizCompleted();
@@ -30,8 +37,10 @@ signals:
 private slots:
     void onRomajiCheckboxChanged(int state);
     void onEnglishCheckboxChanged(int state);
+    void onKanaCheckboxChanged(int state);
     void onStartClicked();
     void onCheckAnswer();
+    void onAnswerEdited(const QString &text);
     void onHintClicked();
     void hideErrorMessage();
     void showNextWord();
@@ -41,10 +50,11 @@ private:
     bool eventFilter(QObject *obj, QEvent *event) override;
     void setupUI();
     void updateCheckboxStates();
-    void checkRomajiAnswer();
-    void checkEnglishAnswer();
     void showError(const QString &correctAnswer = "", const QString &comment = "");
     void showComment(const QString &comment);
+    void setAnswerBorder(const QString &color);
+    void showTypoCorrection(const QString &correction, const QString &comment);
+    static QString highlightedAnswer(QStringView expected, QStringView typed);
     void updateScore();
     void showResults();
     void advanceAfterMessage();
@@ -55,10 +65,12 @@ private:
     QHBoxLayout *checkboxLayout;
     QCheckBox *romajiCheckbox;
     QCheckBox *englishCheckbox;
+    QCheckBox *kanaCheckbox;
     QPushButton *startButton;
     QLabel *questionLabel;
     QLabel *instructionLabel;
     QLineEdit *answerInput;
+    KanaInput *kanaInput; // romaji -> kana for kana answers
     QPushButton *checkButton;
     QPushButton *hintButton;
     QLabel *scoreLabel;
@@ -66,20 +78,13 @@ private:
     QToolButton *settingsButton;
     QMenu *settingsMenu;
     QAction *toggleCommentsAction;
+    QAction *acceptTyposAction;
+    QAction *liveFeedbackAction;
 
-    // Quiz data
-    std::vector<VocabularyWord> vocabularyWords;
-    int currentWordIndex;
-    bool expectingRomaji;
-    bool expectingEnglish;
-
-    // Statistics
-    int correctRomajiCount;
-    int incorrectRomajiCount;
-    int correctEnglishCount;
-    int incorrectEnglishCount;
-    int hintCount; // Track hints used during quiz
-    std::map<VocabularyWord*, int> incorrectWords; // Track incorrect attempts per word
+    // Quiz state, answer checking and statistics
+    VocabularyQuizEngine engine;
+    ProfileStore *profile;
+    SrsScheduler *srs = nullptr;
 
     // Profile and scoring data
     QString profileName;
@@ -91,6 +96,10 @@ private:
     bool showCommentsOnCorrect { true };
     bool initialExpectRomaji { true };
     bool initialExpectEnglish { true };
+    bool initialExpectKana { false };
+    bool acceptTypos { true };
+    bool liveFeedback { false };
+    QString answerBorderColor;
 };
 
 #endif // VOCABULARYQUIZWINDOW_H
\ No newline at end of file
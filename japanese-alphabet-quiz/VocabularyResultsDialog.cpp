@@ -1,4 +1,5 @@
 #include "VocabularyResultsDialog.h"
+#include "SessionRandom.h"
 #include <QFont>
 #include <QIcon>
 #include <QScrollArea>
@@ -10,8 +11,12 @@ VocabularyResultsDialog::VocabularyResultsDialog(
     int incorrectRomajiCount,
     int correctEnglishCount,
     int incorrectEnglishCount,
+    bool expectingKana,
+    int correctKanaCount,
+    int incorrectKanaCount,
     int hintCount,
-    const std::map<VocabularyWord*, int> &incorrectWords,
+    const DeckStore &store,
+    const std::map<WordId, int> &incorrectWords,
     QWidget *parent)
     : QDialog(parent), choice(ReturnToMenu) {
 
@@ -101,9 +106,29 @@ VocabularyResultsDialog::VocabularyResultsDialog(
         summaryLayout->addWidget(englishLabel);
     }
 
+    if (expectingKana) {
+        int totalKana = correctKanaCount + incorrectKanaCount;
+        double kanaPercent = totalKana > 0 ? (double(correctKanaCount) / totalKana * 100) : 0;
+
+        QString percentColor = "#27ae60";
+        if (kanaPercent < percentageMedium) percentColor = "#e74c3c";
+        else if (kanaPercent < percentageHigh) percentColor = "#f39c12";
+
+        QLabel *kanaLabel = new QLabel(
+            QString("<span style='font-size: 18px;'>あ</span> Kana: %1 correct, %2 incorrect (<span style='color: %3; font-weight: bold; font-size: 16px;'>%4%</span>)")
+            .arg(correctKanaCount)
+            .arg(incorrectKanaCount)
+            .arg(percentColor)
+            .arg(QString::number(kanaPercent, 'f', 1)),
+            this
+        );
+        kanaLabel->setStyleSheet(labelStyle);
+        summaryLayout->addWidget(kanaLabel);
+    }
+
     // Overall accuracy
-    int totalCorrect = correctRomajiCount + correctEnglishCount;
-    int totalIncorrect = incorrectRomajiCount + incorrectEnglishCount;
+    int totalCorrect = correctRomajiCount + correctEnglishCount + correctKanaCount;
+    int totalIncorrect = incorrectRomajiCount + incorrectEnglishCount + incorrectKanaCount;
     int totalAnswers = totalCorrect + totalIncorrect;
 
     if (totalAnswers > 0) {
@@ -138,6 +163,12 @@ VocabularyResultsDialog::VocabularyResultsDialog(
         summaryLayout->addWidget(hintLabel);
     }
 
+    // Session seed, so a reported run can be replayed with --seed
+    QLabel *seedLabel = new QLabel(QString("Session seed: %1").arg(SessionRandom::seed()), this);
+    seedLabel->setStyleSheet("font-size: 11px; color: #7f8c8d; border: none;");
+    seedLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    summaryLayout->addWidget(seedLabel);
+
     // Add summary widget to main layout (always visible)
     mainLayout->addWidget(summaryWidget);
 
@@ -162,7 +193,7 @@ VocabularyResultsDialog::VocabularyResultsDialog(
         wordsLayout->addWidget(practiceLabel);
 
         // Sort incorrect words by mistake count (descending)
-        std::vector<std::pair<const VocabularyWord*, int>> sortedIncorrect;
+        std::vector<std::pair<WordId, int>> sortedIncorrect;
         for (const auto &pair : incorrectWords) {
             sortedIncorrect.push_back({pair.first, pair.second});
         }
@@ -170,11 +201,10 @@ VocabularyResultsDialog::VocabularyResultsDialog(
                   [](const auto &a, const auto &b) { return a.second > b.second; });
 
         for (const auto &pair : sortedIncorrect) {
-            const VocabularyWord *word = pair.first;
+            DeckStore::WordView word = store.word(pair.first);
             int count = pair.second;
-            QString keyWord = word->hiragana.isEmpty() ? (word->katakana.isEmpty() ? word->kanji : word->katakana) : word->hiragana;
             QString wordText = QString("• %1 (%2) → %3")
-                              .arg(keyWord, word->romaji, word->english);
+                              .arg(word.displayText(), word.romaji(), word.english());
 
             if (count > 1) {
                 wordText += QString(" - %1 mistake%2").arg(count).arg(count > 1 ? "s" : "");
@@ -7,7 +7,7 @@
 #include <QLabel>
 #include <QPushButton>
 #include <map>
-#include "VocabularyData.h"
+#include "DeckStore.h"
 
 class VocabularyResultsDialog : public QDialog {
     Q_OBJECT
@@ -25,8 +25,12 @@ public:
         int incorrectRomajiCount,
         int correctEnglishCount,
         int incorrectEnglishCount,
+        bool expectingKana,
+        int correctKanaCount,
+        int incorrectKanaCount,
         int hintCount,
-        const std::map<VocabularyWord*, int> &incorrectWords,
+        const DeckStore &store,
+        const std::map<WordId, int> &incorrectWords,
         QWidget *parent = nullptr
     );
 
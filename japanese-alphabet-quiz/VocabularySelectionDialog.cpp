@@ -11,12 +11,12 @@
 #include <QDir>
 #include <QSet>
 
-VocabularySelectionDialog::VocabularySelectionDialog(const std::vector<Vocabulary> &vocabularies, 
+VocabularySelectionDialog::VocabularySelectionDialog(const DeckStore &decks, 
                                                    const ProfileScores &scores,
-                                                   const QString &profileName,
+                                                   ProfileStore *profile,
                                                    int initialMessageDurationSeconds,
                                                    QWidget *parent)
-    : QDialog(parent), practiceAll(false), practiceSelected(false), selectedIndex(-1), vocabularies(vocabularies), scores(scores), profileName(profileName), initialMessageDurationSeconds(initialMessageDurationSeconds) {
+    : QDialog(parent), practiceAll(false), practiceSelected(false), selectedIndex(-1), decks(decks), scores(scores), profile(profile), initialMessageDurationSeconds(initialMessageDurationSeconds) {
     
     setWindowTitle("Select Vocabulary");
     setFixedSize(550, 500);
@@ -192,15 +192,15 @@ VocabularySelectionDialog::VocabularySelectionDialog(const std::vector<Vocabular
     });
     
     // Enable/disable practice button based on selection
-    practiceButton->setEnabled(!vocabularies.empty());
-    practiceAllButton->setEnabled(!vocabularies.empty());
+    practiceButton->setEnabled(!decks.isEmpty());
+    practiceAllButton->setEnabled(!decks.isEmpty());
     
     // Load selected words and enable/disable the practice selected button
     loadSelectedWords();
     practiceSelectedButton->setEnabled(!selectedWords.empty());
     
     // Select first item by default if available
-    if (!vocabularies.empty()) {
+    if (!decks.isEmpty()) {
         vocabularyComboBox->setCurrentIndex(0);
         selectedIndex = 0;
     }
@@ -215,14 +215,14 @@ void VocabularySelectionDialog::onPracticeClicked() {
 }
 
 void VocabularySelectionDialog::populateVocabularyComboBox() {
-    for (size_t i = 0; i < vocabularies.size(); ++i) {
-        const Vocabulary &vocab = vocabularies[i];
-        VocabularyScore score = VocabularyData::getProfileVocabularyScore(scores, profileName, vocab.name);
+    for (int i = 0; i < decks.deckCount(); ++i) {
+        QString name = decks.deckName(i).toString();
+        VocabularyScore score = VocabularyData::getProfileVocabularyScore(scores, name);
         
         // Create formatted text with scores
         QString itemText = QString("%1 (%2 words)")
-                          .arg(vocab.name)
-                          .arg(vocab.words.size());
+                          .arg(name)
+                          .arg(decks.deckWordCount(i));
         
         QString scoreText = "";
         if (score.bestRomajiPercent > 0 || score.bestEnglishPercent > 0) {
@@ -257,7 +257,7 @@ void VocabularySelectionDialog::onPracticeSelectedClicked() {
 }
 
 void VocabularySelectionDialog::onSelectWordsClicked() {
-    WordSelectionDialog dialog(vocabularies, profileName, this);
+    WordSelectionDialog dialog(decks, profile, this);
     if (dialog.exec() == QDialog::Accepted) {
         loadSelectedWords(); // Reload after selection dialog closes
         practiceSelectedButton->setEnabled(!selectedWords.empty());
@@ -275,36 +275,18 @@ int VocabularySelectionDialog::getMessageDuration() const {
     return 2; // default seconds fallback
 }
 
-std::vector<VocabularyWord> VocabularySelectionDialog::getSelectedWords() const {
+std::vector<WordId> VocabularySelectionDialog::getSelectedWords() const {
     return selectedWords;
 }
 
 void VocabularySelectionDialog::loadSelectedWords() {
     selectedWords.clear();
     
-    QString profilePath = QDir::currentPath() + "/profiles/" + profileName + ".json";
-    QFile profileFile(profilePath);
-    
-    if (!profileFile.open(QIODevice::ReadOnly)) {
+    QJsonArray selectedWordsArray = profile->arrayValue("selectedWords");
+    if (selectedWordsArray.isEmpty()) {
         return; // No saved selection
     }
     
-    QByteArray data = profileFile.readAll();
-    profileFile.close();
-    
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        return;
-    }
-    
-    QJsonObject obj = doc.object();
-    if (!obj.contains("selectedWords") || !obj["selectedWords"].isArray()) {
-        return;
-    }
-    
-    QJsonArray selectedWordsArray = obj["selectedWords"].toArray();
-    
     // Create a set of selected word keys for quick lookup
     QSet<QString> selectedWordKeys;
     for (const QJsonValue &value : selectedWordsArray) {
@@ -313,14 +295,12 @@ void VocabularySelectionDialog::loadSelectedWords() {
         }
     }
     
-    // Find the selected words in vocabularies
-    for (const Vocabulary &vocab : vocabularies) {
-        for (const VocabularyWord &word : vocab.words) {
-            QString keyWord = word.hiragana.isEmpty() ? (word.katakana.isEmpty() ? word.kanji : word.katakana) : word.hiragana;
-            QString wordKey = QString("%1|%2|%3").arg(keyWord, word.romaji, word.english);
-            if (selectedWordKeys.contains(wordKey)) {
-                selectedWords.push_back(word);
-            }
+    // Find the selected words in the decks
+    for (WordId id = 0; id < WordId(decks.wordCount()); ++id) {
+        DeckStore::WordView word = decks.word(id);
+        QString wordKey = QString("%1|%2|%3").arg(word.displayText(), word.romaji(), word.english());
+        if (selectedWordKeys.contains(wordKey)) {
+            selectedWords.push_back(id);
         }
     }
 }
\ No newline at end of file
@@ -11,14 +11,16 @@
 #include <QListWidgetItem>
 #include <QSpinBox>
 #include "VocabularyData.h"
+#include "DeckStore.h"
+#include "ProfileStore.h"
 
 class VocabularySelectionDialog : public QDialog {
     Q_OBJECT
 
 public:
-    explicit VocabularySelectionDialog(const std::vector<Vocabulary> &vocabularies, 
+    explicit VocabularySelectionDialog(const DeckStore &decks, 
                                      const ProfileScores &scores,
-                                     const QString &profileName,
+                                     ProfileStore *profile,
                                      int initialMessageDurationSeconds = 2,
                                      QWidget *parent = nullptr);
     
@@ -26,7 +28,7 @@ public:
     bool isPracticeSelected() const { return practiceSelected; }
     int getSelectedVocabularyIndex() const { return selectedIndex; }
     int getMessageDuration() const;
-    std::vector<VocabularyWord> getSelectedWords() const;
+    std::vector<WordId> getSelectedWords() const;
 
 private slots:
     void onPracticeClicked();
@@ -50,10 +52,10 @@ private:
     bool practiceAll;
     bool practiceSelected;
     int selectedIndex;
-    std::vector<VocabularyWord> selectedWords;
-    const std::vector<Vocabulary> &vocabularies;
+    std::vector<WordId> selectedWords;
+    const DeckStore &decks;
     const ProfileScores &scores;
-    const QString &profileName;
+    ProfileStore *profile;
     int initialMessageDurationSeconds;
 };
 
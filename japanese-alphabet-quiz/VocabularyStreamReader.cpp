@@ -0,0 +1,326 @@
+#include "VocabularyStreamReader.h"
+#include <QFile>
+
+namespace {
+constexpr qint64 ChunkSize = 64 * 1024;
+constexpr int MaxDepth = 512;
+
+void appendUtf8(QByteArray &out, uint cp) {
+    if (cp < 0x80) {
+        out.append(char(cp));
+    } else if (cp < 0x800) {
+        out.append(char(0xC0 | (cp >> 6)));
+        out.append(char(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.append(char(0xE0 | (cp >> 12)));
+        out.append(char(0x80 | ((cp >> 6) & 0x3F)));
+        out.append(char(0x80 | (cp & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (cp >> 18)));
+        out.append(char(0x80 | ((cp >> 12) & 0x3F)));
+        out.append(char(0x80 | ((cp >> 6) & 0x3F)));
+        out.append(char(0x80 | (cp & 0x3F)));
+    }
+}
+}
+
+bool VocabularyStreamReader::readFile(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = "Failed to open vocabulary file: " + filePath;
+        return false;
+    }
+    return read(file);
+}
+
+bool VocabularyStreamReader::read(QIODevice &dev) {
+    device = &dev;
+    buffer.clear();
+    pos = 0;
+    consumed = 0;
+    totalBytes = dev.isSequential() ? -1 : dev.size();
+    nextProgress = progressInterval;
+    cancelled = false;
+    error.clear();
+
+    // Tolerate a UTF-8 byte order mark
+    if (peek() == 0xEF) {
+        if (get() != 0xEF || get() != 0xBB || get() != 0xBF)
+            return fail("Invalid byte order mark");
+    }
+    bool ok = readRoot();
+    if (ok) {
+        skipWhitespace();
+        if (peek() >= 0) ok = fail("Garbage at the end of the document");
+    }
+    if (ok && onProgress) onProgress(consumed + buffer.size(), totalBytes);
+    device = nullptr;
+    return ok;
+}
+
+// --- Byte input ---
+
+bool VocabularyStreamReader::fill() {
+    if (cancelled) return false;
+    consumed += buffer.size();
+    buffer = device->read(ChunkSize);
+    pos = 0;
+    if (buffer.isEmpty()) return false;
+    qint64 bytesRead = consumed + buffer.size();
+    if (onProgress && bytesRead >= nextProgress) {
+        nextProgress = bytesRead + progressInterval;
+        if (!onProgress(bytesRead, totalBytes)) {
+            cancelled = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+int VocabularyStreamReader::peek() {
+    if (pos >= buffer.size() && !fill()) return -1;
+    return static_cast<unsigned char>(buffer[pos]);
+}
+
+int VocabularyStreamReader::get() {
+    int c = peek();
+    if (c >= 0) ++pos;
+    return c;
+}
+
+void VocabularyStreamReader::skipWhitespace() {
+    for (int c = peek(); c == ' ' || c == '\n' || c == '\r' || c == '\t'; c = peek())
+        ++pos;
+}
+
+bool VocabularyStreamReader::expect(char c) {
+    skipWhitespace();
+    if (get() == static_cast<unsigned char>(c)) return true;
+    return fail(QString("Expected '%1'").arg(QLatin1Char(c)));
+}
+
+bool VocabularyStreamReader::fail(const QString &message) {
+    // A cancelled read unwinds through here too; that is not a parse error.
+    if (!cancelled && error.isEmpty())
+        error = QString("%1 at offset %2").arg(message).arg(consumed + pos);
+    return false;
+}
+
+// --- Generic JSON ---
+
+bool VocabularyStreamReader::readString(QByteArray &out) {
+    out.clear();
+    if (!expect('"')) return false;
+    while (true) {
+        // Copy plain runs straight out of the buffer
+        int start = pos;
+        while (pos < buffer.size()) {
+            unsigned char c = static_cast<unsigned char>(buffer[pos]);
+            if (c == '"' || c == '\\' || c < 0x20) break;
+            ++pos;
+        }
+        out.append(buffer.constData() + start, pos - start);
+        int c = get();
+        if (c < 0) return fail("Unterminated string");
+        if (c == '"') return true;
+        if (c < 0x20) return fail("Control character in string");
+        if (c != '\\') {
+            out.append(char(c));
+            continue;
+        }
+        switch (get()) {
+        case '"': out.append('"'); break;
+        case '\\': out.append('\\'); break;
+        case '/': out.append('/'); break;
+        case 'b': out.append('\b'); break;
+        case 'f': out.append('\f'); break;
+        case 'n': out.append('\n'); break;
+        case 'r': out.append('\r'); break;
+        case 't': out.append('\t'); break;
+        case 'u': {
+            auto readHex = [this](uint &value) {
+                value = 0;
+                for (int i = 0; i < 4; ++i) {
+                    int h = get();
+                    int digit = h >= '0' && h <= '9' ? h - '0'
+                              : h >= 'a' && h <= 'f' ? h - 'a' + 10
+                              : h >= 'A' && h <= 'F' ? h - 'A' + 10 : -1;
+                    if (digit < 0) return false;
+                    value = value * 16 + uint(digit);
+                }
+                return true;
+            };
+            uint cp;
+            if (!readHex(cp)) return fail("Invalid \\u escape");
+            if (cp >= 0xD800 && cp < 0xDC00) {
+                uint low;
+                if (get() != '\\' || get() != 'u' || !readHex(low) || low < 0xDC00 || low >= 0xE000)
+                    return fail("Invalid surrogate pair");
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            } else if (cp >= 0xDC00 && cp < 0xE000) {
+                cp = 0xFFFD;
+            }
+            appendUtf8(out, cp);
+            break;
+        }
+        default:
+            return fail("Invalid escape");
+        }
+    }
+}
+
+// Reads a string value; any other value is skipped and reads as empty,
+// matching QJsonValue::toString().
+bool VocabularyStreamReader::readStringValue(QString &out) {
+    skipWhitespace();
+    if (peek() != '"') {
+        out.clear();
+        return skipValue();
+    }
+    QByteArray bytes;
+    if (!readString(bytes)) return false;
+    out = QString::fromUtf8(bytes);
+    return true;
+}
+
+bool VocabularyStreamReader::readLiteral(const char *literal) {
+    for (const char *p = literal; *p; ++p) {
+        if (get() != static_cast<unsigned char>(*p)) return fail("Invalid literal");
+    }
+    return true;
+}
+
+bool VocabularyStreamReader::skipValue(int depth) {
+    if (depth > MaxDepth) return fail("Nesting too deep");
+    skipWhitespace();
+    int c = peek();
+    switch (c) {
+    case '"': {
+        QByteArray ignored;
+        return readString(ignored);
+    }
+    case '{':
+        return readObject([this, depth](const QByteArray &) { return skipValue(depth + 1); });
+    case '[':
+        return readArray([this, depth]() { return skipValue(depth + 1); });
+    case 't': return readLiteral("true");
+    case 'f': return readLiteral("false");
+    case 'n': return readLiteral("null");
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            while ((c = peek()) == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= '0' && c <= '9'))
+                ++pos;
+            return true;
+        }
+        return fail(c < 0 ? "Unexpected end of file" : "Unexpected character");
+    }
+}
+
+bool VocabularyStreamReader::readObject(const std::function<bool(const QByteArray &key)> &onMember) {
+    if (!expect('{')) return false;
+    skipWhitespace();
+    if (peek() == '}') {
+        ++pos;
+        return true;
+    }
+    QByteArray key;
+    while (true) {
+        if (!readString(key) || !expect(':') || !onMember(key)) return false;
+        skipWhitespace();
+        int c = get();
+        if (c == '}') return true;
+        if (c != ',') return fail("Expected ',' or '}'");
+    }
+}
+
+bool VocabularyStreamReader::readArray(const std::function<bool()> &onElement) {
+    if (!expect('[')) return false;
+    skipWhitespace();
+    if (peek() == ']') {
+        ++pos;
+        return true;
+    }
+    while (true) {
+        if (!onElement()) return false;
+        skipWhitespace();
+        int c = get();
+        if (c == ']') return true;
+        if (c != ',') return fail("Expected ',' or ']'");
+    }
+}
+
+// --- Deck structure ---
+
+bool VocabularyStreamReader::readRoot() {
+    skipWhitespace();
+    if (peek() != '{') return fail("Invalid JSON structure - not an object");
+    bool haveVocabularies = false;
+    bool ok = readObject([this, &haveVocabularies](const QByteArray &key) {
+        skipWhitespace();
+        if (key != "Vocabularies" || peek() != '[') return skipValue();
+        haveVocabularies = true;
+        return readArray([this]() {
+            skipWhitespace();
+            return peek() == '{' ? readVocabulary() : skipValue();
+        });
+    });
+    if (!ok) return false;
+    if (!haveVocabularies) return fail("Missing or invalid 'Vocabularies' array");
+    return true;
+}
+
+bool VocabularyStreamReader::readVocabulary() {
+    Vocabulary vocab;
+    bool ok = readObject([this, &vocab](const QByteArray &key) {
+        skipWhitespace();
+        if (key == "Vocabulary" && peek() == '"')
+            return readStringValue(vocab.name);
+        if (key == "words" && peek() == '[') {
+            return readArray([this, &vocab]() {
+                skipWhitespace();
+                return peek() == '{' ? readWord(vocab) : skipValue();
+            });
+        }
+        return skipValue();
+    });
+    if (!ok) return false;
+    // Unnamed vocabularies are dropped, as before
+    if (vocab.name.isEmpty() || !onVocabulary) return true;
+    if (!onVocabulary(vocab)) {
+        cancelled = true;
+        return false;
+    }
+    return true;
+}
+
+bool VocabularyStreamReader::readWord(Vocabulary &vocab) {
+    VocabularyWord word;
+    bool haveHiragana = false;
+    bool ok = readObject([this, &word, &haveHiragana](const QByteArray &key) {
+        if (key == "japanese") { // backwards compatibility
+            QString value;
+            if (!readStringValue(value)) return false;
+            if (!haveHiragana) word.hiragana = value;
+            return true;
+        }
+        if (key == "hiragana") {
+            haveHiragana = true;
+            return readStringValue(word.hiragana);
+        }
+        if (key == "katakana") return readStringValue(word.katakana);
+        if (key == "romaji") return readStringValue(word.romaji);
+        if (key == "english") return readStringValue(word.english);
+        if (key == "kanji") return readStringValue(word.kanji);
+        if (key == "comment") return readStringValue(word.comment);
+        if (key == "hint") return readStringValue(word.hint);
+        return skipValue();
+    });
+    if (!ok) return false;
+    if (word.hiragana.isEmpty() || word.romaji.isEmpty() || word.english.isEmpty()) return true;
+    if (onWord && !onWord(word)) {
+        cancelled = true;
+        return false;
+    }
+    vocab.words.push_back(std::move(word));
+    return true;
+}
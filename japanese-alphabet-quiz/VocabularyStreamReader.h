@@ -0,0 +1,71 @@
+#ifndef VOCABULARYSTREAMREADER_H
+#define VOCABULARYSTREAMREADER_H
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <functional>
+#include "VocabularyData.h"
+
+// Reads a vocabularies.json file ({"Vocabularies": [{"Vocabulary": name,
+// "words": [...]}, ...]}) in fixed-size chunks and hands out each vocabulary
+// as soon as its object closes, without building a JSON DOM. Only the
+// vocabulary being read is held in memory besides what the handlers keep.
+class VocabularyStreamReader {
+public:
+    // Return false from a handler to stop reading early.
+    using VocabularyHandler = std::function<bool(Vocabulary &vocab)>;
+    using WordHandler = std::function<bool(const VocabularyWord &word)>;
+    using ProgressHandler = std::function<bool(qint64 bytesRead, qint64 totalBytes)>;
+
+    void setVocabularyHandler(VocabularyHandler handler) { onVocabulary = std::move(handler); }
+    void setWordHandler(WordHandler handler) { onWord = std::move(handler); }
+    // Called roughly every `interval` bytes and once at the end.
+    void setProgressHandler(ProgressHandler handler, qint64 interval = 1 << 20) {
+        onProgress = std::move(handler);
+        progressInterval = interval;
+    }
+
+    // Return false on malformed input or when a handler stopped the read.
+    bool readFile(const QString &filePath);
+    bool read(QIODevice &device);
+    // True if a handler stopped the read; the data seen so far was valid.
+    bool wasCancelled() const { return cancelled; }
+    QString errorString() const { return error; }
+
+private:
+    // Byte input
+    bool fill();
+    int peek();
+    int get();
+    void skipWhitespace();
+    bool expect(char c);
+    bool fail(const QString &message);
+
+    // Generic JSON
+    bool readString(QByteArray &out);
+    bool readStringValue(QString &out);
+    bool skipValue(int depth = 0);
+    bool readLiteral(const char *literal);
+    bool readObject(const std::function<bool(const QByteArray &key)> &onMember);
+    bool readArray(const std::function<bool()> &onElement);
+
+    // Deck structure
+    bool readRoot();
+    bool readVocabulary();
+    bool readWord(Vocabulary &vocab);
+
+    QIODevice *device = nullptr;
+    QByteArray buffer;
+    int pos = 0;
+    qint64 consumed = 0; // bytes before `buffer`
+    qint64 totalBytes = 0;
+    qint64 nextProgress = 0;
+    qint64 progressInterval = 1 << 20;
+    bool cancelled = false;
+    QString error;
+    VocabularyHandler onVocabulary;
+    WordHandler onWord;
+    ProgressHandler onProgress;
+};
+
+#endif // VOCABULARYSTREAMREADER_H
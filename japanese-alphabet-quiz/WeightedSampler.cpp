@@ -0,0 +1,48 @@
+#include "WeightedSampler.h"
+
+WeightedSampler::WeightedSampler(std::size_t size) {
+    reset(size);
+}
+
+void WeightedSampler::reset(std::size_t size) {
+    tree.assign(size + 1, 0);
+    weights.assign(size, 0);
+    sum = 0;
+    topBit = 1;
+    while (topBit * 2 <= size) topBit *= 2;
+}
+
+void WeightedSampler::assign(const std::vector<std::uint64_t> &newWeights) {
+    reset(newWeights.size());
+    weights = newWeights;
+    // O(n) bulk build: push each node's partial sum to its parent once.
+    for (std::size_t i = 1; i < tree.size(); ++i) {
+        tree[i] += weights[i - 1];
+        sum += weights[i - 1];
+        std::size_t parent = i + (i & (~i + 1));
+        if (parent < tree.size()) tree[parent] += tree[i];
+    }
+}
+
+void WeightedSampler::setWeight(std::size_t index, std::uint64_t weight) {
+    std::uint64_t old = weights[index];
+    if (old == weight) return;
+    weights[index] = weight;
+    sum = sum - old + weight;
+    // Unsigned wrap-around makes the same loop handle increases and decreases.
+    std::uint64_t delta = weight - old;
+    for (std::size_t i = index + 1; i < tree.size(); i += i & (~i + 1))
+        tree[i] += delta;
+}
+
+std::size_t WeightedSampler::find(std::uint64_t target) const {
+    std::size_t pos = 0;
+    for (std::size_t step = topBit; step > 0; step >>= 1) {
+        std::size_t next = pos + step;
+        if (next < tree.size() && tree[next] <= target) {
+            pos = next;
+            target -= tree[next];
+        }
+    }
+    return pos; // 0-based index of the (pos + 1)th element
+}
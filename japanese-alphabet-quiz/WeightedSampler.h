@@ -0,0 +1,36 @@
+#ifndef WEIGHTEDSAMPLER_H
+#define WEIGHTEDSAMPLER_H
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Fenwick (binary indexed) tree over integer weights. Supports O(log n)
+// weight updates and O(log n) weighted draws without rebuilding anything,
+// so a quiz can keep one sampler alive for the whole round.
+class WeightedSampler {
+public:
+    explicit WeightedSampler(std::size_t size = 0);
+    void reset(std::size_t size);
+    void assign(const std::vector<std::uint64_t> &weights);
+    void setWeight(std::size_t index, std::uint64_t weight);
+    std::uint64_t weight(std::size_t index) const { return weights[index]; }
+    std::uint64_t total() const { return sum; }
+    std::size_t size() const { return weights.size(); }
+    // Index whose cumulative weight range contains target (0 <= target < total()).
+    std::size_t find(std::uint64_t target) const;
+
+    template <typename Rng>
+    std::size_t sample(Rng &rng) const {
+        std::uniform_int_distribution<std::uint64_t> dist(0, sum - 1);
+        return find(dist(rng));
+    }
+
+private:
+    std::vector<std::uint64_t> tree; // 1-based
+    std::vector<std::uint64_t> weights;
+    std::uint64_t sum = 0;
+    std::size_t topBit = 0;
+};
+
+#endif // WEIGHTEDSAMPLER_H
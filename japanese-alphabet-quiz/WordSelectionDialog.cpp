@@ -4,10 +4,10 @@
 #include <QMessageBox>
 #include <QJsonParseError>
 
-WordSelectionDialog::WordSelectionDialog(const std::vector<Vocabulary> &vocabularies,
-                                        const QString &profileName,
+WordSelectionDialog::WordSelectionDialog(const DeckStore &decks,
+                                        ProfileStore *profile,
                                         QWidget *parent)
-    : QDialog(parent), vocabularies(vocabularies), profileName(profileName) {
+    : QDialog(parent), decks(decks), profile(profile) {
     
     setWindowTitle("Select Words to Practice");
     setFixedSize(800, 600);
@@ -143,9 +143,9 @@ void WordSelectionDialog::setupUI() {
 }
 
 void WordSelectionDialog::populateWords() {
-    for (const Vocabulary &vocab : vocabularies) {
+    for (int deck = 0; deck < decks.deckCount(); ++deck) {
         // Create group box for each vocabulary
-        QGroupBox *groupBox = new QGroupBox(vocab.name, scrollWidget);
+        QGroupBox *groupBox = new QGroupBox(decks.deckName(deck).toString(), scrollWidget);
         QVBoxLayout *groupLayout = new QVBoxLayout(groupBox);
         
         groupBox->setStyleSheet(
@@ -163,9 +163,11 @@ void WordSelectionDialog::populateWords() {
             "}"
         );
         
-        for (const VocabularyWord &word : vocab.words) {
+        const WordId first = decks.deckFirstWord(deck);
+        for (WordId id = first; id < first + WordId(decks.deckWordCount(deck)); ++id) {
+            DeckStore::WordView word = decks.word(id);
             QCheckBox *checkBox = new QCheckBox(
-                QString("%1 (%2) - %3").arg(word.hiragana.isEmpty() ? (word.katakana.isEmpty() ? word.kanji : word.katakana) : word.hiragana, word.romaji, word.english), 
+                QString("%1 (%2) - %3").arg(word.displayText(), word.romaji(), word.english()), 
                 groupBox
             );
             
@@ -184,8 +186,7 @@ void WordSelectionDialog::populateWords() {
             
             WordCheckBox wordCB;
             wordCB.checkBox = checkBox;
-            wordCB.word = word;
-            wordCB.vocabularyName = vocab.name;
+            wordCB.word = id;
             wordCheckBoxes.push_back(wordCB);
         }
         
@@ -193,8 +194,8 @@ void WordSelectionDialog::populateWords() {
     }
 }
 
-std::vector<VocabularyWord> WordSelectionDialog::getSelectedWords() const {
-    std::vector<VocabularyWord> selectedWords;
+std::vector<WordId> WordSelectionDialog::getSelectedWords() const {
+    std::vector<WordId> selectedWords;
     
     for (const WordCheckBox &wordCB : wordCheckBoxes) {
         if (wordCB.checkBox->isChecked()) {
@@ -206,29 +207,11 @@ std::vector<VocabularyWord> WordSelectionDialog::getSelectedWords() const {
 }
 
 void WordSelectionDialog::loadSelectedWords() {
-    QString profilePath = QDir::currentPath() + "/profiles/" + profileName + ".json";
-    QFile profileFile(profilePath);
-    
-    if (!profileFile.open(QIODevice::ReadOnly)) {
+    QJsonArray selectedWordsArray = profile->arrayValue("selectedWords");
+    if (selectedWordsArray.isEmpty()) {
         return; // No saved selection
     }
     
-    QByteArray data = profileFile.readAll();
-    profileFile.close();
-    
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        return;
-    }
-    
-    QJsonObject obj = doc.object();
-    if (!obj.contains("selectedWords") || !obj["selectedWords"].isArray()) {
-        return;
-    }
-    
-    QJsonArray selectedWordsArray = obj["selectedWords"].toArray();
-    
     // Create a set of selected word keys for quick lookup
     QSet<QString> selectedWordKeys;
     for (const QJsonValue &value : selectedWordsArray) {
@@ -239,8 +222,8 @@ void WordSelectionDialog::loadSelectedWords() {
     
     // Check the checkboxes for selected words
     for (const WordCheckBox &wordCB : wordCheckBoxes) {
-        QString keyWord = wordCB.word.hiragana.isEmpty() ? (wordCB.word.katakana.isEmpty() ? wordCB.word.kanji : wordCB.word.katakana) : wordCB.word.hiragana;
-        QString wordKey = QString("%1|%2|%3").arg(keyWord, wordCB.word.romaji, wordCB.word.english);
+        DeckStore::WordView word = decks.word(wordCB.word);
+        QString wordKey = QString("%1|%2|%3").arg(word.displayText(), word.romaji(), word.english());
         if (selectedWordKeys.contains(wordKey)) {
             wordCB.checkBox->setChecked(true);
         }
@@ -248,38 +231,17 @@ void WordSelectionDialog::loadSelectedWords() {
 }
 
 void WordSelectionDialog::saveSelectedWords() {
-    QString profilePath = QDir::currentPath() + "/profiles/" + profileName + ".json";
-    QFile profileFile(profilePath);
-    
-    QJsonObject obj;
-    if (profileFile.open(QIODevice::ReadOnly)) {
-        QByteArray data = profileFile.readAll();
-        profileFile.close();
-        
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-        if (parseError.error == QJsonParseError::NoError && doc.isObject()) {
-            obj = doc.object();
-        }
-    }
-    
     // Create array of selected words
     QJsonArray selectedWordsArray;
     for (const WordCheckBox &wordCB : wordCheckBoxes) {
         if (wordCB.checkBox->isChecked()) {
-            QString keyWord = wordCB.word.hiragana.isEmpty() ? (wordCB.word.katakana.isEmpty() ? wordCB.word.kanji : wordCB.word.katakana) : wordCB.word.hiragana;
-            QString wordKey = QString("%1|%2|%3").arg(keyWord, wordCB.word.romaji, wordCB.word.english);
+            DeckStore::WordView word = decks.word(wordCB.word);
+            QString wordKey = QString("%1|%2|%3").arg(word.displayText(), word.romaji(), word.english());
             selectedWordsArray.append(wordKey);
         }
     }
     
-    obj["selectedWords"] = selectedWordsArray;
-    
-    if (profileFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        QJsonDocument outDoc(obj);
-        profileFile.write(outDoc.toJson(QJsonDocument::Indented));
-        profileFile.close();
-    }
+    profile->setValue("selectedWords", selectedWordsArray);
 }
 
 void WordSelectionDialog::onSelectAllClicked() {
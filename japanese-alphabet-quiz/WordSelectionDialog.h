@@ -14,17 +14,18 @@
 #include <QJsonDocument>
 #include <QFile>
 #include <QDir>
-#include "VocabularyData.h"
+#include "DeckStore.h"
+#include "ProfileStore.h"
 
 class WordSelectionDialog : public QDialog {
     Q_OBJECT
 
 public:
-    explicit WordSelectionDialog(const std::vector<Vocabulary> &vocabularies,
-                                const QString &profileName,
+    explicit WordSelectionDialog(const DeckStore &decks,
+                                ProfileStore *profile,
                                 QWidget *parent = nullptr);
     
-    std::vector<VocabularyWord> getSelectedWords() const;
+    std::vector<WordId> getSelectedWords() const;
     void loadSelectedWords();
     void saveSelectedWords();
 
@@ -38,8 +39,8 @@ private:
     void setupUI();
     void populateWords();
     
-    const std::vector<Vocabulary> &vocabularies;
-    const QString &profileName;
+    const DeckStore &decks;
+    ProfileStore *profile;
     
     QScrollArea *scrollArea;
     QWidget *scrollWidget;
@@ -52,8 +53,7 @@ private:
     
     struct WordCheckBox {
         QCheckBox *checkBox;
-        VocabularyWord word;
-        QString vocabularyName;
+        WordId word;
     };
     
     std::vector<WordCheckBox> wordCheckBoxes;
@@ -0,0 +1,329 @@
+// Synthetic workloads for the quiz, matching and persistence hot paths.
+//
+//   benchmarks [--sizes 1000,100000,1000000] [--out results.json]
+//              [--baseline baseline.json] [--threshold 0.2] [--save-baseline]
+//
+// Results are JSON: one entry per case with the best-of-N nanoseconds per
+// item. With --baseline, any case more than --threshold slower than its
+// baseline entry is reported and the exit code is 1.
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include "AlphabetQuizEngine.h"
+#include "DeckStore.h"
+#include "KanaComposer.h"
+#include "SessionRandom.h"
+#include "SrsScheduler.h"
+#include "VocabularyCache.h"
+#include "VocabularyData.h"
+#include "VocabularyQuizEngine.h"
+
+namespace {
+
+struct Result {
+    QString name;
+    qint64 items = 0;
+    double nsPerItem = 0;
+};
+
+// Runs `body` a few times (fewer for big inputs) and keeps the fastest run;
+// `setup` runs untimed before each repetition.
+Result measure(const QString &name, qint64 items, const std::function<void()> &setup, const std::function<void()> &body) {
+    int reps = items >= 1000000 ? 3 : items >= 100000 ? 5 : 20;
+    qint64 best = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < reps; ++i) {
+        if (setup) setup();
+        QElapsedTimer timer;
+        timer.start();
+        body();
+        best = std::min(best, timer.nsecsElapsed());
+    }
+    Result r;
+    r.name = QString("%1/%2").arg(name).arg(items);
+    r.items = items;
+    r.nsPerItem = double(best) / double(std::max<qint64>(items, 1));
+    return r;
+}
+
+VocabularyWord syntheticWord(qint64 i) {
+    VocabularyWord w;
+    w.hiragana = QString("ことば%1").arg(i);
+    w.romaji = QString("kotoba%1 / kotoba-%1").arg(i);
+    w.english = QString("word %1 / term %1").arg(i);
+    if (i % 7 == 0) w.comment = "Synthetic comment";
+    if (i % 11 == 0) w.hint = "Synthetic hint";
+    return w;
+}
+
+// Words are spread over vocabularies of 100 words each.
+std::vector<Vocabulary> syntheticVocabularies(qint64 words) {
+    std::vector<Vocabulary> vocabs;
+    for (qint64 i = 0; i < words; ++i) {
+        if (i % 100 == 0) {
+            vocabs.emplace_back();
+            vocabs.back().name = QString("Vocabulary %1").arg(i / 100);
+        }
+        vocabs.back().words.push_back(syntheticWord(i));
+    }
+    return vocabs;
+}
+
+// One profile's scores file with `entries` vocabularies.
+ProfileScores syntheticScores(qint64 entries) {
+    ProfileScores scores;
+    for (qint64 i = 0; i < entries; ++i) {
+        VocabularyScore &s = scores[QString("Vocabulary %1").arg(i)];
+        s.bestRomajiPercent = double(i % 101);
+        s.bestEnglishPercent = double((i * 7) % 101);
+    }
+    return scores;
+}
+
+void runAlphabet(qint64 n, std::vector<Result> &results) {
+    // One round of n questions over every character; every fifth answer is
+    // wrong. The journal path is left empty, so this is the in-memory path.
+    AlphabetQuizEngine engine;
+    AlphabetQuizEngine::CharSet all;
+    all.set();
+    engine.setEnabledChars(all);
+    AlphabetQuizConfig config;
+    config.timesToShow = int(std::max<qint64>(1, n / AlphabetData::CellCount));
+    config.weightedPractice = true;
+    engine.setConfig(config);
+    qint64 questions = qint64(config.timesToShow) * AlphabetData::CellCount;
+
+    results.push_back(measure("alphabet.newRound", questions, nullptr, [&] { engine.newRound(); }));
+    results.push_back(measure("alphabet.nextQuestion+answer", questions, [&] { engine.newRound(); }, [&] {
+        qint64 asked = 0;
+        while (engine.nextQuestion(true) == AlphabetQuizEngine::Draw::Drawn) {
+            AlphabetData::CharId id = engine.current();
+            bool wrong = ++asked % 5 == 0;
+            engine.answer(wrong ? QStringLiteral("?") : AlphabetData::romajiText(id));
+        }
+    }));
+}
+
+void runVocabulary(qint64 n, const QString &dir, std::vector<Result> &results) {
+    std::vector<Vocabulary> vocabs = syntheticVocabularies(n);
+    QString vocabPath = dir + QString("/vocabulary-%1.json").arg(n);
+    results.push_back(measure("vocabulary.save", n, nullptr, [&] {
+        VocabularyData::saveVocabularies(vocabPath, vocabs);
+    }));
+    // The first load after a save parses the JSON and compiles the cache;
+    // later loads are served from the cache.
+    DeckStore loaded;
+    QString cachePath = VocabularyCache::cachePathFor(vocabPath);
+    results.push_back(measure("vocabulary.load", n, [&] { QFile::remove(cachePath); }, [&] {
+        VocabularyData::loadVocabularies(vocabPath, loaded);
+    }));
+    results.push_back(measure("vocabulary.loadCached", n, nullptr, [&] {
+        VocabularyData::loadVocabularies(vocabPath, loaded);
+    }));
+    VocabularyCache cache;
+    results.push_back(measure("vocabulary.openCache", n, [&] { cache.close(); }, [&] {
+        cache.open(cachePath, vocabPath);
+    }));
+    DeckStore store;
+    results.push_back(measure("vocabulary.buildStore", n, nullptr, [&] {
+        store = DeckStore::fromVocabularies(vocabs);
+    }));
+    AnswerMatcher matcher;
+    results.push_back(measure("vocabulary.buildAnswers", n, nullptr, [&] {
+        matcher.build(store);
+    }));
+    qInfo().noquote() << QString("deckstore/%1: %2 bytes per word").arg(n).arg(double(store.memoryUsage()) / double(std::max<qint64>(n, 1)), 0, 'f', 1);
+    std::vector<WordId> all;
+    results.push_back(measure("vocabulary.allWords", n, nullptr, [&] {
+        all = store.allWords();
+    }));
+    volatile qint64 displayed = 0; // keeps the scan from being optimised out
+    results.push_back(measure("vocabulary.scanWords", n, nullptr, [&] {
+        for (WordId id : all) displayed += store.word(id).displayText().size();
+    }));
+
+    ProfileScores scores = syntheticScores(n);
+    QString scoresPath = dir + QString("/scores-%1.json").arg(n);
+    results.push_back(measure("scores.save", n, nullptr, [&] {
+        VocabularyData::saveProfileScores(scoresPath, scores);
+    }));
+    ProfileScores loadedScores;
+    results.push_back(measure("scores.load", n, nullptr, [&] {
+        VocabularyData::loadProfileScores(scoresPath, loadedScores);
+    }));
+
+    // Answer checking in each mode; half the answers are wrong.
+    std::vector<QString> romajiAnswers, englishAnswers, bothAnswers, typoAnswers, spelledAnswers;
+    for (qint64 i = 0; i < n; ++i) {
+        DeckStore::WordView w = store.word(all[size_t(i)]);
+        bool right = i % 2 == 0;
+        QString romaji = right ? w.romaji().toString().section(" / ", 1, 1) : QStringLiteral("nanika");
+        QString english = right ? w.english().toString().section(" / ", 0, 0) : QStringLiteral("something");
+        romajiAnswers.push_back(romaji);
+        englishAnswers.push_back(english);
+        bothAnswers.push_back(romaji + ", " + english);
+        // One letter short: misses the exact lookup and takes the typo path
+        typoAnswers.push_back(w.english().toString().section(" / ", 0, 0).chopped(1));
+        // Not listed, so only the Romanizer accepts it
+        spelledAnswers.push_back(QString("ko to ba %1").arg(i));
+    }
+    VocabularyQuizEngine engine(store, all);
+    auto answerAll = [&engine](const VocabularyQuizConfig &config, const std::vector<QString> &answers) {
+        engine.start(config);
+        for (const QString &a : answers) {
+            engine.answer(a);
+            engine.advance();
+        }
+    };
+    results.push_back(measure("answer.romaji", n, nullptr, [&] { answerAll({true, false}, romajiAnswers); }));
+    results.push_back(measure("answer.english", n, nullptr, [&] { answerAll({false, true}, englishAnswers); }));
+    results.push_back(measure("answer.both", n, nullptr, [&] { answerAll({true, true}, bothAnswers); }));
+    results.push_back(measure("answer.englishTypo", n, nullptr, [&] { answerAll({false, true}, typoAnswers); }));
+    results.push_back(measure("answer.romajiSpelled", n, nullptr, [&] { answerAll({true, false}, spelledAnswers); }));
+    // Live feedback: every prefix of each answer, as if typed key by key
+    volatile int liveStates = 0;
+    results.push_back(measure("answer.liveKeystrokes", n, nullptr, [&] {
+        engine.start({false, true});
+        for (const QString &a : englishAnswers) {
+            for (qsizetype k = 1; k <= a.size(); ++k) liveStates += int(engine.liveProgress(QStringView(a).left(k)));
+            engine.advance();
+        }
+    }));
+    // Reverse mode: romaji converted to kana key by key, as the input field does
+    volatile qsizetype composed = 0;
+    results.push_back(measure("kana.composeKeystrokes", n, nullptr, [&] {
+        KanaComposer composer;
+        for (const QString &a : romajiAnswers) {
+            for (QChar c : a) composed += composer.type(c).size();
+            composed += composer.flush().size();
+        }
+    }));
+
+    // Review scheduling: one card per word, then a review session that
+    // always takes the most overdue card, the way "Review due" does
+    std::vector<QString> cardKeys;
+    cardKeys.reserve(all.size());
+    for (WordId id : all) cardKeys.push_back(SrsScheduler::wordKey(store.word(id)));
+    const std::int64_t now = 1700000000;
+    SrsScheduler srs;
+    results.push_back(measure("srs.review", n, [&] { srs.clear(); }, [&] {
+        for (qint64 i = 0; i < n; ++i)
+            srs.review(cardKeys[size_t(i)], i % 5 == 0 ? SrsScheduler::Grade::Again : SrsScheduler::Grade::Good, now + i);
+    }));
+    const std::int64_t later = now + 400LL * 24 * 3600; // everything is due
+    results.push_back(measure("srs.reviewDue", n, nullptr, [&] {
+        for (qint64 i = 0; i < n; ++i) {
+            std::vector<QString> due = srs.due(later, 1);
+            if (due.empty()) break;
+            srs.review(due.front(), SrsScheduler::Grade::Good, later);
+        }
+    }));
+    QString srsPath = dir + QString("/profile-%1.srs").arg(n);
+    results.push_back(measure("srs.save", n, nullptr, [&] { srs.save(srsPath); }));
+    results.push_back(measure("srs.load", n, nullptr, [&] { srs.load(srsPath); }));
+}
+
+QJsonObject toJson(const std::vector<Result> &results) {
+    QJsonArray arr;
+    for (const Result &r : results) {
+        QJsonObject o;
+        o["name"] = r.name;
+        o["items"] = r.items;
+        o["ns_per_item"] = r.nsPerItem;
+        arr.append(o);
+    }
+    QJsonObject root;
+    root["benchmarks"] = arr;
+    return root;
+}
+
+// Prints each case against the baseline; returns the number of regressions.
+int compare(const std::vector<Result> &results, const QJsonObject &baseline, double threshold, QTextStream &out) {
+    QHash<QString, double> base;
+    for (const QJsonValue &v : baseline["benchmarks"].toArray())
+        base.insert(v["name"].toString(), v["ns_per_item"].toDouble());
+    int regressions = 0;
+    for (const Result &r : results) {
+        auto it = base.constFind(r.name);
+        if (it == base.constEnd() || it.value() <= 0) {
+            out << r.name << ": " << r.nsPerItem << " ns/item (no baseline)\n";
+            continue;
+        }
+        double change = r.nsPerItem / it.value() - 1.0;
+        bool regressed = change > threshold;
+        if (regressed) ++regressions;
+        out << r.name << ": " << r.nsPerItem << " ns/item vs " << it.value()
+            << QString(" (%1%2%)").arg(change >= 0 ? "+" : "").arg(change * 100, 0, 'f', 1)
+            << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    return regressions;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Quiz hot-path benchmarks");
+    parser.addHelpOption();
+    QCommandLineOption sizesOpt("sizes", "Comma-separated workload sizes.", "list", "1000,100000,1000000");
+    QCommandLineOption outOpt("out", "Write results JSON here (default: stdout).", "file");
+    QCommandLineOption baselineOpt("baseline", "Compare against this results JSON.", "file");
+    QCommandLineOption thresholdOpt("threshold", "Allowed slowdown before a case counts as a regression.", "fraction", "0.2");
+    QCommandLineOption saveOpt("save-baseline", "Overwrite the --baseline file with these results.");
+    parser.addOptions({sizesOpt, outOpt, baselineOpt, thresholdOpt, saveOpt});
+    parser.process(app);
+
+    // Same question order on every run
+    SessionRandom::seedFixed(12345);
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        qWarning() << "Cannot create a temporary directory";
+        return 2;
+    }
+    std::vector<Result> results;
+    for (const QString &s : parser.value(sizesOpt).split(',', Qt::SkipEmptyParts)) {
+        qint64 n = s.trimmed().toLongLong();
+        if (n <= 0) continue;
+        runAlphabet(n, results);
+        runVocabulary(n, dir.path(), results);
+    }
+
+    QByteArray json = QJsonDocument(toJson(results)).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outOpt)) {
+        QFile f(parser.value(outOpt));
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(json) != json.size()) {
+            qWarning() << "Cannot write" << f.fileName();
+            return 2;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    if (!parser.isSet(baselineOpt)) return 0;
+    QFile baselineFile(parser.value(baselineOpt));
+    if (parser.isSet(saveOpt)) {
+        if (!baselineFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) return 2;
+        baselineFile.write(json);
+        return 0;
+    }
+    if (!baselineFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "No baseline at" << baselineFile.fileName() << "- record one with --save-baseline";
+        return 0;
+    }
+    QTextStream err(stderr);
+    int regressions = compare(results, QJsonDocument::fromJson(baselineFile.readAll()).object(),
+                              parser.value(thresholdOpt).toDouble(), err);
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,43 @@
+// Reverse (kana) answers in the alphabet quiz engine.
+#include <QtTest>
+#include "AlphabetQuizEngine.h"
+
+class AlphabetQuizEngineTests : public QObject {
+    Q_OBJECT
+
+private:
+    // An engine in kana mode whose only question is `kana`
+    static void askOnly(AlphabetQuizEngine &engine, QStringView kana) {
+        AlphabetQuizConfig config;
+        config.typeKana = true;
+        engine.setConfig(config);
+        AlphabetQuizEngine::CharSet chars;
+        chars.set(AlphabetData::findKana(kana));
+        engine.setEnabledChars(chars);
+        engine.newRound();
+        QCOMPARE(engine.nextQuestion(), AlphabetQuizEngine::Draw::Drawn);
+    }
+
+private slots:
+    void kanaOfAnotherLengthWithTheSameRomaji() {
+        // ウォ and ヲ are both "wo", and the composer turns "wo" into ヲ
+        AlphabetQuizEngine engine;
+        askOnly(engine, u"ウォ");
+        QCOMPARE(engine.liveProgress(u"ウ"), AnswerTrie::Progress::Prefix);
+        QCOMPARE(engine.liveProgress(u"ヲ"), AnswerTrie::Progress::UniqueComplete);
+        QCOMPARE(engine.liveProgress(u"を"), AnswerTrie::Progress::Mismatch);
+        QVERIFY(engine.answer("ヲ"));
+    }
+
+    void kanaReadAlike() {
+        AlphabetQuizEngine engine;
+        askOnly(engine, u"じ");
+        QCOMPARE(engine.liveProgress(u"ぢ"), AnswerTrie::Progress::UniqueComplete);
+        QVERIFY(engine.answer("ぢ"));
+        QVERIFY(!AlphabetData::sameReading(u"し", u"ち"));
+        QVERIFY(!AlphabetData::sameReading(u"ウォ", u"を"));
+    }
+};
+
+QTEST_APPLESS_MAIN(AlphabetQuizEngineTests)
+#include "AlphabetQuizEngineTests.moc"
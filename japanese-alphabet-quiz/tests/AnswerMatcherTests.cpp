@@ -0,0 +1,58 @@
+// Answer checking against the Romanizer's readings of a word's kana.
+#include <QtTest>
+#include "DeckStore.h"
+#include "Romanizer.h"
+
+class AnswerMatcherTests : public QObject {
+    Q_OBJECT
+
+private:
+    static DeckStore store(const QList<VocabularyWord> &words) {
+        Vocabulary vocab;
+        vocab.name = "Test";
+        vocab.words.assign(words.begin(), words.end());
+        return DeckStore::fromVocabularies({vocab});
+    }
+
+private slots:
+    void particleReadingsFollowAWord() {
+        const unsigned particles = Romanizer::ParticleReadings;
+        QVERIFY(Romanizer::accepts(u"こんにちは", u"konnichiwa", particles));
+        QVERIFY(Romanizer::accepts(u"わたしは", u"watashiwa", particles));
+        QVERIFY(Romanizer::accepts(u"わたし は がくせい", u"watashi wa gakusei", particles));
+        QVERIFY(!Romanizer::accepts(u"はな", u"wana", particles));
+        QVERIFY(!Romanizer::accepts(u"へや", u"eya", particles));
+        QVERIFY(!Romanizer::accepts(u"きれいな はな", u"kireina wana", particles));
+        QVERIFY(!Romanizer::accepts(u"こんにちは", u"konnichiwa"));
+    }
+
+    void particleReadingsOnlyWhereListed() {
+        DeckStore decks = store({{"konnichiwa", "hello", "こんにちは"},
+                                 {"hana", "flower", "はな"},
+                                 {"heya", "room", "へや"},
+                                 {"haha", "mother", "はは"}});
+        const AnswerMatcher &answers = decks.answers();
+        QVERIFY(answers.matches(0, AnswerMatcher::Romaji, u"konnichiwa"));
+        QVERIFY(answers.matches(0, AnswerMatcher::Romaji, u"konnitiwa"));
+        QVERIFY(answers.matches(1, AnswerMatcher::Romaji, u"hana"));
+        QVERIFY(!answers.matches(1, AnswerMatcher::Romaji, u"wana"));
+        QVERIFY(!answers.matches(2, AnswerMatcher::Romaji, u"eya"));
+        QVERIFY(!answers.matches(3, AnswerMatcher::Romaji, u"wawa"));
+        QVERIFY(!answers.matches(3, AnswerMatcher::Romaji, u"hawa"));
+        // Live feedback must not call them complete either
+        QCOMPARE(answers.progress(1, AnswerMatcher::Romaji, u"wana"), AnswerTrie::Progress::Mismatch);
+        QCOMPARE(answers.progress(2, AnswerMatcher::Romaji, u"eya"), AnswerTrie::Progress::Mismatch);
+    }
+
+    void progressIgnoresSurroundingSpaces() {
+        DeckStore decks = store({{"hana", "flower", "はな"}});
+        const AnswerMatcher &answers = decks.answers();
+        QVERIFY(answers.matches(0, AnswerMatcher::English, u"flower "));
+        QCOMPARE(answers.progress(0, AnswerMatcher::English, u"flower "), AnswerTrie::Progress::UniqueComplete);
+        QCOMPARE(answers.progress(0, AnswerMatcher::English, u" flo "), AnswerTrie::Progress::Prefix);
+        QCOMPARE(answers.progress(0, AnswerMatcher::Romaji, u"hana  "), AnswerTrie::Progress::UniqueComplete);
+    }
+};
+
+QTEST_APPLESS_MAIN(AnswerMatcherTests)
+#include "AnswerMatcherTests.moc"
@@ -0,0 +1,36 @@
+// QuizGame driven through a QuizWindow, without showing it.
+#include <QtTest>
+#include "ProfileStore.h"
+#include "QuizGame.h"
+#include "QuizWindow.h"
+
+class QuizGameTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void loadingPreferencesRebuildsOnce() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        ProfileStore profile(dir.filePath("tester.json"));
+        profile.setValues({{"katakana_cb", false},
+                           {"times_to_show", 3},
+                           {"weighted_practice", true},
+                           {"type_kana", true}});
+        QuizWindow window(&profile);
+        auto *game = new QuizGame(&window); // owned by the window
+        const AlphabetQuizEngine &engine = game->quizEngine();
+        QSignalSpy rounds(&engine, &AlphabetQuizEngine::roundStarted);
+
+        window.loadPreferences();
+
+        QCOMPARE(rounds.count(), 1);
+        QCOMPARE(engine.config().timesToShow, 3);
+        QVERIFY(engine.config().weightedPractice);
+        QVERIFY(engine.config().typeKana);
+        const AlphabetData::RowSpan &katakana = AlphabetData::rowSpan(AlphabetData::Script::Katakana, 0);
+        QVERIFY(!engine.enabledChars()[static_cast<CharId>(katakana.firstCell)]);
+    }
+};
+
+QTEST_MAIN(QuizGameTests)
+#include "QuizGameTests.moc"